@@ -87,6 +87,7 @@ main (int argc, char *argv[])
   bool disablePl = true;
   uint32_t simulationId = 1;
   uint32_t numberOfClients = 1;
+  uint32_t parallelConnections = 1;
   double simTime = 10.1;
   std::string DashTraceFile = "report.csv";
   std::string ServerThroughputTraceFile = "server_throughput.csv";
@@ -96,6 +97,7 @@ main (int argc, char *argv[])
   CommandLine cmd;
   cmd.AddValue("numberOfEnbs", "Number of eNBs", numberOfEnbs);
   cmd.AddValue("numberOfClients", "Number of UEs in total", numberOfClients);
+  cmd.AddValue("parallelConnections", "Number of connections each UE downloads segments on in parallel", parallelConnections);
   cmd.AddValue("simTime", "Total duration of the simulation [s])", simTime);
   cmd.AddValue("distance", "Distance between eNBs [m]", distance);
   cmd.AddValue("interPacketInterval", "Inter packet interval [ms])", interPacketInterval);
@@ -290,6 +292,7 @@ main (int argc, char *argv[])
 			client.SetAttribute("AllowDownscale", BooleanValue(true));
 			client.SetAttribute("AllowUpscale", BooleanValue(true));
 			client.SetAttribute("MaxBufferedSeconds", StringValue("1600"));
+			client.SetAttribute("ParallelConnections", UintegerValue(parallelConnections));
 
 			clientApps.Add(client.Install(ueNodes.Get(u)));
 
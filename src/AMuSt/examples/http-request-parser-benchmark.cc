@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Micro-benchmark of the HTTP request parser of the fake servers: parses pipelined segment requests,
+// as sent by the DASH clients, fed in chunks of chunkSize bytes, and reports requests per second
+
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+
+#include "ns3/core-module.h"
+#include "ns3/http-request-parser.h"
+
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("HttpRequestParserBenchmark");
+
+
+int main (int argc, char *argv[])
+{
+  uint32_t numberOfRequests = 1000000;
+  uint32_t chunkSize = 536;
+  uint32_t pipelineDepth = 4;
+
+  CommandLine cmd;
+  cmd.AddValue ("requests", "Number of requests to parse", numberOfRequests);
+  cmd.AddValue ("chunkSize", "Number of bytes fed to the parser at once, e.g., the TCP segment size", chunkSize);
+  cmd.AddValue ("pipelineDepth", "Number of requests parsed before they are popped", pipelineDepth);
+  cmd.Parse (argc, argv);
+
+  if (chunkSize == 0 || pipelineDepth == 0)
+  {
+    std::cerr << "chunkSize and pipelineDepth must be greater than 0" << std::endl;
+    return 1;
+  }
+
+  // one batch of pipelined requests, looking like the requests of HttpClientApplication
+  std::stringstream requestsSS;
+  for (uint32_t i = 0; i < pipelineDepth; i++)
+  {
+    requestsSS << "GET /content/segments/vid1/repr_" << (i % 10) << "_seg_" << i << ".264 HTTP/1.1\r\n";
+    requestsSS << "Host: localhost\r\n";
+    requestsSS << "Accept: text/html,application/xml\r\n";
+    requestsSS << "User-Agent: ns-3 (applications/model/http-client.cc)\r\n";
+    requestsSS << "Accept-Encoding: identity\r\n";
+    requestsSS << "Connection: keep-alive\r\n";
+    requestsSS << "\r\n";
+  }
+  std::string requests = requestsSS.str();
+  const uint8_t* data = (const uint8_t*) requests.data();
+
+  HttpRequestParser parser;
+  uint64_t parsedRequests = 0;
+  uint64_t uriBytes = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+  while (parsedRequests < numberOfRequests)
+  {
+    for (size_t pos = 0; pos < requests.size(); pos += chunkSize)
+    {
+      size_t size = std::min((size_t) chunkSize, requests.size() - pos);
+      if (!parser.Parse(data + pos, size))
+      {
+        std::cerr << "Parse error" << std::endl;
+        return 1;
+      }
+    }
+
+    while (parser.HasRequest())
+    {
+      uriBytes += parser.GetRequest().uri.size();
+      parser.PopRequest();
+      parsedRequests++;
+    }
+  }
+
+  double wallClock = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  std::cout << parsedRequests << " requests (" << requests.size() / pipelineDepth << " bytes each, "
+            << uriBytes / parsedRequests << " bytes URI) parsed in " << wallClock << " s, "
+            << parsedRequests / wallClock << " requests per second" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Benchmark of installing DASHPlayerTracer on many DASH clients: for every number of nodes, a DASH client
+// is installed on each node, and the time to install the tracers by connecting to the applications directly
+// is compared to connecting them through a config path per node
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <list>
+#include <stdlib.h>
+#include <string>
+#include <chrono>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/AMuSt-module.h"
+#include "ns3/dash-http-client-helper.h"
+#include "ns3/dashplayer-tracer.h"
+
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TracerInstallBenchmark");
+
+
+int main (int argc, char *argv[])
+{
+  std::string nodeCounts = "1000,10000";
+  std::string traceFile = "tracer-install-benchmark.txt";
+  bool compareConfigPath = true;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Comma separated numbers of nodes to install the tracers on", nodeCounts);
+  cmd.AddValue ("traceFile", "The file the tracers write to", traceFile);
+  cmd.AddValue ("compareConfigPath", "Also connect the tracers through a config path per node", compareConfigPath);
+  cmd.Parse (argc, argv);
+
+  DASHHttpClientHelper client ("http://10.0.0.1/content/mpds/vid1.mpd.gz");
+
+  // the tracers connected through config paths are kept until the end, like those of DASHPlayerTracer::Install
+  std::list< Ptr<DASHPlayerTracer> > configTracers;
+
+  std::stringstream nodeCountsSS (nodeCounts);
+  std::string nodeCount;
+  while (std::getline (nodeCountsSS, nodeCount, ','))
+  {
+    uint32_t numberOfNodes = atoi (nodeCount.c_str ());
+    if (numberOfNodes == 0)
+      continue;
+
+    NodeContainer nodes;
+    nodes.Create (numberOfNodes);
+    client.Install (nodes);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+    DASHPlayerTracer::Install (nodes, traceFile);
+    double directWallClock = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+    std::cout << numberOfNodes << " nodes (" << NodeList::GetNNodes () << " in total): tracers connected directly in "
+              << directWallClock << " s";
+
+    if (compareConfigPath)
+    {
+      boost::shared_ptr<std::ofstream> os (new std::ofstream ());
+      os->open ((traceFile + ".config").c_str (), std::ios_base::out | std::ios_base::trunc);
+
+      start = std::chrono::steady_clock::now ();
+      for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+      {
+        std::stringstream nodeId;
+        nodeId << (*node)->GetId ();
+        configTracers.push_back (CreateObject<DASHPlayerTracer> (os, nodeId.str ()));
+      }
+      double configWallClock = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+      std::cout << ", through config paths in " << configWallClock << " s";
+    }
+
+    std::cout << std::endl;
+  }
+
+  configTracers.clear ();
+  DASHPlayerTracer::Destroy ();
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -41,6 +41,7 @@
 #include "ns3/pointer.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "dash-fake-server.h"
 
@@ -79,10 +80,19 @@ DASHFakeServerApplication::GetTypeId (void)
                    StringValue("./representations.csv"),
                    MakeStringAccessor(&DASHFakeServerApplication::m_mpdMetaDataFiles),
                    MakeStringChecker())
+    .AddAttribute("RepresentationsSegmentSizesFiles", "Optional comma separated list of segment size files for variable bit rate "
+                   "representations, one per meta data file (may be empty). Each line holds reprId,size_0,size_1,... in bytes",
+                   StringValue(""),
+                   MakeStringAccessor(&DASHFakeServerApplication::m_segmentSizesFiles),
+                   MakeStringChecker())
     .AddAttribute("RepresentationsSegmentsDirectory", "The directory that virtual segments of representations are served",
                    StringValue("/"),
                    MakeStringAccessor(&DASHFakeServerApplication::m_metaDataContentDirectory),
                    MakeStringChecker())
+    .AddAttribute("FileCacheSize", "Maximum number of bytes of files on disk that are kept memory-mapped for all connections",
+                   UintegerValue(64 * 1024 * 1024),
+                   MakeUintegerAccessor(&DASHFakeServerApplication::m_fileCacheSize),
+                   MakeUintegerChecker<uint64_t>())
     .AddAttribute("Hostname", "The (virtual) hostname of this server",
                    StringValue("localhost"),
                    MakeStringAccessor(&DASHFakeServerApplication::m_hostName),
@@ -96,6 +106,7 @@ DASHFakeServerApplication::GetTypeId (void)
 
 
 DASHFakeServerApplication::DASHFakeServerApplication ()
+  : m_socketPool(m_catalog, m_fileCache, MakeCallback(&DASHFakeServerApplication::FinishedCallback, this))
 {
   NS_LOG_FUNCTION (this);
 }
@@ -116,11 +127,71 @@ DASHFakeServerApplication::DoDispose (void)
 
 
 
+// splits a comma separated list, keeping empty items
+static std::vector<std::string>
+SplitCommaSeparatedList(const std::string& list)
+{
+  std::vector<std::string> items;
+  size_t start_pos = 0;
+  size_t pos = list.find(",");
+  while (pos != std::string::npos)
+  {
+    items.push_back(list.substr(start_pos, pos - start_pos));
+    start_pos = pos + 1;
+    pos = list.find(",", start_pos);
+  }
+  items.push_back(list.substr(start_pos));
+  return items;
+}
+
+
+bool
+DASHFakeServerApplication::ImportDASHSegmentSizes (std::string segmentSizesFilename,
+                                                   std::map<std::string, std::vector<long> >& segmentSizes)
+{
+  NS_LOG_FUNCTION(segmentSizesFilename);
+  std::ifstream infile(segmentSizesFilename.c_str());
+  if (!infile.is_open())
+  {
+    NS_LOG_ERROR("Error opening " << segmentSizesFilename);
+    std::cerr << "Error: " << strerror(errno);
+    return false;
+  }
+
+  /*** this is an example of how the file looks like (reprId, then the size of every segment in bytes):
+  1,79041,80172,78230,...
+  2,99623,101244,98014,...
+  */
+
+  std::string line;
+  while (std::getline(infile,line))
+  {
+    size_t pos1 = line.find(",");
+    if (pos1 == std::string::npos)
+      continue;
+
+    std::vector<long>& sizes = segmentSizes[line.substr(0, pos1)];
+    sizes.clear();
+
+    const char* p = line.c_str() + pos1;
+    while (*p == ',')
+    {
+      char* end;
+      sizes.push_back(strtol(p + 1, &end, 10));
+      p = end;
+    }
+  }
+
+  infile.close();
+  return true;
+}
+
+
 std::string /* mpd string */
-DASHFakeServerApplication::ImportDASHRepresentations (std::string mpdMetaDataFilename, int video_id)
+DASHFakeServerApplication::ImportDASHRepresentations (std::string mpdMetaDataFilename, int video_id, std::string segmentSizesFilename)
 {
-  NS_LOG_FUNCTION(mpdMetaDataFilename << video_id);
-// read m_mpdMetaDataFiles and fill m_fileSizes
+  NS_LOG_FUNCTION(mpdMetaDataFilename << video_id << segmentSizesFilename);
+// read m_mpdMetaDataFiles and add the video to m_catalog
   std::ifstream infile(mpdMetaDataFilename.c_str());
   if (!infile.is_open())
   {
@@ -181,6 +252,19 @@ DASHFakeServerApplication::ImportDASHRepresentations (std::string mpdMetaDataFil
   mpdData << "<BaseURL>http://" << m_hostName << m_metaDataContentDirectory  << "vid" << video_id << "/</BaseURL>" << std::endl
           << "<Period start=\"PT0S\">" << std::endl << "<AdaptationSet bitstreamSwitching=\"true\">" << std::endl;
 
+  // segment sizes of variable bit rate representations, all others are constant bit rate
+  std::map<std::string /* repr id */, std::vector<long> > vbrSegmentSizes;
+  if (!segmentSizesFilename.empty())
+  {
+    ImportDASHSegmentSizes(segmentSizesFilename, vbrSegmentSizes);
+  }
+
+  // segments are served from <m_metaDataContentDirectory>vid<video_id>/, their names are decoded by m_catalog on request,
+  // and their sizes are computed from the representation, so no per segment state is kept for constant bit rate
+  std::ostringstream segmentDirectory;
+  segmentDirectory << m_metaDataContentDirectory << "vid" << video_id << "/";
+  uint32_t catalogVideo = m_catalog.AddDASHVideo(segmentDirectory.str());
+
   // get header and ignore
   std::getline(infile,line); // reprId,screenWidth,screenHeight,bitrate
 
@@ -217,16 +301,24 @@ DASHFakeServerApplication::ImportDASHRepresentations (std::string mpdMetaDataFil
 
             long iSegmentSize = (double)iBitrate/8.0 * (double)segment_duration * 1024; // in byte
 
-            for (int i = 0; i < number_of_segments; i++)
+            std::map<std::string, std::vector<long> >::const_iterator vbr = vbrSegmentSizes.find(repr_id);
+            if (vbr != vbrSegmentSizes.end() && vbr->second.size() == (size_t)number_of_segments)
             {
-              std::ostringstream segmentFileName;
-              segmentFileName << "vid" << video_id << "/repr_" << repr_id << "_seg_" << i << ".264";
-
-              m_fileSizes[m_metaDataContentDirectory + segmentFileName.str()] = iSegmentSize;
+              m_catalog.AddDASHRepresentation(catalogVideo, repr_id, vbr->second);
+            }
+            else
+            {
+              if (vbr != vbrSegmentSizes.end())
+              {
+                fprintf(stderr, "Representation ID = %s has %ld segment sizes instead of %d, using constant bit rate\n",
+                        repr_id.c_str(), vbr->second.size(), number_of_segments);
+              }
+              m_catalog.AddDASHRepresentation(catalogVideo, repr_id, number_of_segments, iSegmentSize);
+            }
 
-              m_virtualFiles.push_back(m_metaDataContentDirectory + segmentFileName.str());
-              mpdData << "<SegmentURL media=\"" <<  "repr_" << repr_id << "_seg_" << i << ".264" << "\"/> " << std::endl;
-              //fprintf(stderr, "SegmentName=%s\n", (m_metaDataContentDirectory + segmentFileName.str()).c_str());
+            for (int i = 0; i < number_of_segments; i++)
+            {
+              mpdData << "<SegmentURL media=\"" << HttpServerFileCatalog::GetDASHSegmentName(repr_id, i) << "\"/> " << std::endl;
             }
 
             mpdData << "</SegmentList>" << std::endl << "</Representation>" << std::endl;
@@ -253,11 +345,18 @@ DASHFakeServerApplication::ReportStats()
   uint64_t bytes_recv = m_bytes_recv - m_last_bytes_recv;
   uint64_t bytes_sent = m_bytes_sent - m_last_bytes_sent;
 
-  m_throughputTrace(this, bytes_sent, bytes_recv, m_activeClients.size());
+  // average number of Send calls of the replies finished since the last report
+  const HttpServerReplyStatistics& replyStatistics = m_socketPool.GetReplyStatistics();
+  uint64_t replies = replyStatistics.replies - m_last_reply_statistics.replies;
+  double sendCallsPerReply = replies > 0 ? (double)(replyStatistics.sendCalls - m_last_reply_statistics.sendCalls) / replies : 0.0;
+
+  m_throughputTrace(this, bytes_sent, bytes_recv, m_activeClients.size(),
+                    m_socketPool.GetIdle(), m_socketPool.GetAllocated(), m_socketPool.GetReused(), sendCallsPerReply);
 
 
   m_last_bytes_recv = m_bytes_recv;
   m_last_bytes_sent = m_bytes_sent;
+  m_last_reply_statistics = replyStatistics;
 
   if (m_active)
   {
@@ -291,6 +390,9 @@ DASHFakeServerApplication::StartApplication (void)
 
   m_lastSocketID = 1;
 
+  m_fileCache.SetMaxMappedBytes(m_fileCacheSize);
+  m_socketPool.SetContentDirectory("/");
+
   m_active = true;
 
   Ptr<NetDevice> netdevice = GetNode()->GetDevice(0);
@@ -299,6 +401,7 @@ DASHFakeServerApplication::StartApplication (void)
 
   m_last_bytes_recv = 0;
   m_last_bytes_sent = 0;
+  m_last_reply_statistics = m_socketPool.GetReplyStatistics();
 
   m_bytes_recv = 0;
   m_bytes_sent = 0;
@@ -344,33 +447,12 @@ DASHFakeServerApplication::StartApplication (void)
   );
 
 
-  // parse m_mpdMetaDataFiles, could be comma separated list
-  std::vector<std::string> metaDataRepresentations;
-  size_t pos = m_mpdMetaDataFiles.find(",");
-
-
-
-  if (pos == std::string::npos)
+  // parse m_mpdMetaDataFiles and m_segmentSizesFiles, could be comma separated lists
+  std::vector<std::string> metaDataRepresentations = SplitCommaSeparatedList(m_mpdMetaDataFiles);
+  std::vector<std::string> segmentSizesFiles;
+  if (!m_segmentSizesFiles.empty())
   {
-    // parse one file
-    metaDataRepresentations.push_back(m_mpdMetaDataFiles);
-  } else {
-    // parse multiple files
-    size_t start_pos = 0;
-    std::string parseString = m_mpdMetaDataFiles;
-    while (pos != std::string::npos)
-    {
-      std::string tmpStr = parseString.substr(start_pos, pos);
-
-      metaDataRepresentations.push_back(tmpStr);
-
-      parseString = parseString.substr(pos+1);
-      pos = parseString.find(",");
-    }
-
-    std::string tmpStr = parseString;
-
-    metaDataRepresentations.push_back(tmpStr);
+    segmentSizesFiles = SplitCommaSeparatedList(m_segmentSizesFiles);
   }
 
 
@@ -380,7 +462,8 @@ DASHFakeServerApplication::StartApplication (void)
   for (std::vector<std::string>::iterator it = metaDataRepresentations.begin(); it != metaDataRepresentations.end(); ++it)
   {
     std::string mmm = *it;
-    std::string mpdData = ImportDASHRepresentations(mmm, video_id);
+    std::string sss = (size_t)(video_id-1) < segmentSizesFiles.size() ? segmentSizesFiles[video_id-1] : "";
+    std::string mpdData = ImportDASHRepresentations(mmm, video_id, sss);
 
     // compress
     std::string compressedMpdData = zlib_compress_string(mpdData);
@@ -391,12 +474,9 @@ DASHFakeServerApplication::StartApplication (void)
 
     SSMpdFilename << m_mpdDirectory << "vid" << video_id << ".mpd.gz";
 
-    m_fileSizes[SSMpdFilename.str()] = compressedMpdData.size();
-
-    fprintf(stderr, "Adding '%s' to m_fileSizes with size %ld\n", SSMpdFilename.str().c_str(), compressedMpdData.size());
-
+    fprintf(stderr, "Adding '%s' to m_catalog with size %ld\n", SSMpdFilename.str().c_str(), compressedMpdData.size());
 
-    m_mpdFileContents[SSMpdFilename.str()] = compressedMpdData;
+    m_catalog.AddHostedFile(SSMpdFilename.str(), compressedMpdData);
 
     video_id++;
   }
@@ -444,21 +524,21 @@ DASHFakeServerApplication::ConnectionAccepted (Ptr<Socket> socket, const Address
 
   uint64_t socket_id = RegisterSocket(socket);
 
-  m_activeClients[socket_id] = new HttpServerFakeVirtualClientSocket(socket_id, "/", m_fileSizes, m_virtualFiles, m_mpdFileContents,
-                  MakeCallback(&DASHFakeServerApplication::FinishedCallback, this));
+  HttpServerFakeVirtualClientSocket* client = m_socketPool.Allocate(socket_id);
+  m_activeClients[socket_id] = client;
 
   NS_LOG_DEBUG (socket << " " << Simulator::Now () << " Successful socket id : " << socket_id << " Connection Accepted From " << address);
 
   // set callbacks for this socket to be in HttpServerFakeClientSocket class
-  socket->SetSendCallback (MakeCallback (&HttpServerFakeVirtualClientSocket::HandleReadyToTransmit, m_activeClients[socket_id]));
-  socket->SetRecvCallback (MakeCallback (&HttpServerFakeVirtualClientSocket::HandleIncomingData, m_activeClients[socket_id]));
+  socket->SetSendCallback (MakeCallback (&HttpServerFakeVirtualClientSocket::HandleReadyToTransmit, client));
+  socket->SetRecvCallback (MakeCallback (&HttpServerFakeVirtualClientSocket::HandleIncomingData, client));
 
 
   socket->TraceConnectWithoutContext ("State",
-    MakeCallback(&HttpServerFakeVirtualClientSocket::LogStateChange, m_activeClients[socket_id]));
+    MakeCallback(&HttpServerFakeVirtualClientSocket::LogStateChange, client));
 
-  socket->SetCloseCallbacks (MakeCallback (&HttpServerFakeVirtualClientSocket::ConnectionClosedNormal, m_activeClients[socket_id]),
-                             MakeCallback (&HttpServerFakeVirtualClientSocket::ConnectionClosedError,  m_activeClients[socket_id]));
+  socket->SetCloseCallbacks (MakeCallback (&HttpServerFakeVirtualClientSocket::ConnectionClosedNormal, client),
+                             MakeCallback (&HttpServerFakeVirtualClientSocket::ConnectionClosedError,  client));
 }
 
 
@@ -468,19 +548,33 @@ DASHFakeServerApplication::ConnectionAccepted (Ptr<Socket> socket, const Address
 void
 DASHFakeServerApplication::FinishedCallback (uint64_t socket_id)
 {
-  // create timer to finish this, because if we do it in here, we will crash the app
-  Simulator::Schedule(Seconds(1.0), &DASHFakeServerApplication::DoFinishSocket, this, socket_id);
+  // the client socket calls this from within its socket callbacks, so it is finished after the current event
+  Simulator::ScheduleNow(&DASHFakeServerApplication::DoFinishSocket, this, socket_id);
 }
 
 void
 DASHFakeServerApplication::DoFinishSocket(uint64_t socket_id)
 {
-  if (m_activeClients.find(socket_id) != m_activeClients.end())
+  std::map<uint64_t, HttpServerFakeVirtualClientSocket*>::iterator it = m_activeClients.find(socket_id);
+  if (it == m_activeClients.end())
+    return;
+
+  HttpServerFakeVirtualClientSocket* client = it->second;
+  m_activeClients.erase(it);
+
+  // make sure the socket no longer calls the client socket, before it is reused for another connection
+  std::map<uint64_t, Ptr<Socket> >::iterator sit = m_activeSockets.find(socket_id);
+  if (sit != m_activeSockets.end())
   {
-    HttpServerFakeClientSocket* tmp = m_activeClients[socket_id];
-    m_activeClients.erase(socket_id);
-    delete tmp; // TODO: CHECK
+    Ptr<Socket> socket = sit->second;
+    socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+    socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+    socket->TraceDisconnectWithoutContext ("State", MakeCallback(&HttpServerFakeVirtualClientSocket::LogStateChange, client));
+    m_activeSockets.erase(sit);
   }
+
+  m_socketPool.Release(client);
 }
 
 
@@ -491,7 +585,7 @@ DASHFakeServerApplication::DoFinishSocket(uint64_t socket_id)
 uint64_t
 DASHFakeServerApplication::RegisterSocket (Ptr<Socket> socket)
 {
-  this->m_activeSockets[socket] = this->m_lastSocketID;
+  this->m_activeSockets[this->m_lastSocketID] = socket;
 
   return this->m_lastSocketID++;
 }
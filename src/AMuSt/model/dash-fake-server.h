@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "http-server-fake-virtual-clientsocket.h"
+#include "http-server-client-socket-pool.h"
 
 
 #define CRLF "\r\n"
@@ -75,8 +76,15 @@ protected:
   uint64_t m_last_bytes_recv;
   uint64_t m_last_bytes_sent;
 
+  HttpServerReplyStatistics m_last_reply_statistics; ///< \brief reply statistics of the socket pool at the last report
 
-  std::string ImportDASHRepresentations (std::string mpdMetaDataFilename, int video_id);
+
+  std::string ImportDASHRepresentations (std::string mpdMetaDataFilename, int video_id, std::string segmentSizesFilename);
+
+  /**
+   * \brief Read the segment sizes of variable bit rate representations
+   */
+  bool ImportDASHSegmentSizes (std::string segmentSizesFilename, std::map<std::string, std::vector<long> >& segmentSizes);
 
 
   bool ConnectionRequested (Ptr<Socket> socket, const Address& address);
@@ -84,7 +92,9 @@ protected:
 
 
   TracedCallback<Ptr<ns3::Application> /*App*/,
-    uint64_t /* TxBytes*/,uint64_t /* RxBytes */, uint32_t /* ConnectionCount */> m_throughputTrace;
+    uint64_t /* TxBytes*/,uint64_t /* RxBytes */, uint32_t /* ConnectionCount */,
+    uint32_t /* IdleSocketHandlers */, uint64_t /* AllocatedSocketHandlers */, uint64_t /* ReusedSocketHandlers */,
+    double /* SendCallsPerReply */> m_throughputTrace;
 
 
   /**
@@ -93,17 +103,19 @@ protected:
   uint64_t RegisterSocket(Ptr<Socket> socket);
 
 private:
-  std::map<Ptr<Socket> /* socket */, uint64_t /* socket id */  > m_activeSockets;
+  std::map<uint64_t /* socket id */, Ptr<Socket> /* socket */ > m_activeSockets;
 
-  std::map<uint64_t /* socket id */, HttpServerFakeClientSocket* /* client_socket */ > m_activeClients;
+  std::map<uint64_t /* socket id */, HttpServerFakeVirtualClientSocket* /* client_socket */ > m_activeClients;
 
 
   std::map<uint64_t /* socket id */, std::string /* packet buffer */ > m_activePackets;
 
-  std::map<std::string, long> m_fileSizes;
-  std::vector<std::string> m_virtualFiles;
+  HttpServerFileCatalog m_catalog; ///< \brief the MPDs and virtual segments served by this server
+
+  HttpServerFileCache m_fileCache; ///< \brief the files on disk served by this server, memory-mapped
+  uint64_t m_fileCacheSize;
 
-  std::map<std::string, std::string> m_mpdFileContents;
+  HttpServerClientSocketPool<HttpServerFakeVirtualClientSocket> m_socketPool; ///< \brief the handlers of the client sockets, reused for new connections
 
   uint64_t m_lastSocketID;
 
@@ -131,6 +143,7 @@ private:
 
   std::string m_mpdDirectory;
   std::string m_mpdMetaDataFiles;
+  std::string m_segmentSizesFiles;
   std::string m_metaDataContentDirectory;
   std::string m_hostName;
   Address m_listeningAddress;
@@ -10,6 +10,7 @@
 #include "ns3/boolean.h"
 #include "ns3/core-module.h"
 #include "ns3/trace-source-accessor.h"
+#include "node-application-traces.h"
 
 #include <boost/shared_ptr.hpp>
 
@@ -141,15 +142,7 @@ DASHPlayerTracer::DASHPlayerTracer(boost::shared_ptr<std::ofstream> os, Ptr<Node
 
   m_node = node_id_str.str();
 
-  // if this is a node with only 1 application, connect directly to the player tracer (if available)
-  if (node->GetNApplications() == 1)
-  {
-    node->GetApplication(0)->TraceConnectWithoutContext ("PlayerTracer", MakeCallback(&DASHPlayerTracer::ConsumeStats,
-                                             this));
-  } else {
-    // else: use normal connect method
-    Connect();
-  }
+  ConnectApplicationTraces(m_nodePtr, "PlayerTracer", MakeCallback(&DASHPlayerTracer::ConsumeStats, this));
 }
 
 DASHPlayerTracer::DASHPlayerTracer(boost::shared_ptr<std::ofstream> os, const std::string& node)
@@ -31,6 +31,7 @@
 #include "ns3/simulator.h"
 #include "ns3/string.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
@@ -40,6 +41,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
 #include "http-client.h"
 
 
@@ -80,10 +82,24 @@ HttpClientApplication::GetTypeId (void)
                    StringValue(""),
                    MakeStringAccessor(&HttpClientApplication::m_outFile),
                    MakeStringChecker())
+    .AddAttribute("DownloadSink", "Where downloaded files go: discarded, kept in memory or written to WriteOutfile",
+                   EnumValue(HttpDownloadSink::OUTFILE),
+                   MakeEnumAccessor(&HttpClientApplication::m_downloadSinkMode),
+                   MakeEnumChecker(HttpDownloadSink::DISCARD, "Discard",
+                                   HttpDownloadSink::MEMORY, "Memory",
+                                   HttpDownloadSink::OUTFILE, "File"))
     .AddAttribute("KeepAlive", "Whether or not the connection should be re-used every time (default: false)",
                    BooleanValue(false),
                    MakeBooleanAccessor(&HttpClientApplication::m_keepAlive),
                    MakeBooleanChecker())
+    .AddAttribute("MaxPipelinedRequests", "Maximum number of requests sent on a KeepAlive connection before their responses are received",
+                   UintegerValue(1),
+                   MakeUintegerAccessor(&HttpClientApplication::m_maxPipelinedRequests),
+                   MakeUintegerChecker<uint32_t>(1))
+    .AddAttribute("MaxConnections", "Maximum number of parallel connections to the server that requests are spread over",
+                   UintegerValue(1),
+                   MakeUintegerAccessor(&HttpClientApplication::m_maxConnections),
+                   MakeUintegerChecker<uint32_t>(1))
     .AddTraceSource("FileDownloadFinished", "Trace called every time a download finishes",
                    MakeTraceSourceAccessor(&HttpClientApplication::m_downloadFinishedTrace),
                    "bla")
@@ -105,31 +121,40 @@ HttpClientApplication::HttpClientApplication ()
   NS_LOG_FUNCTION (this);
   m_sent = 0;
   node_id = 0;
-  m_socket = 0;
-
-  _tmpbuffer = NULL; // init this thing
 
   m_tried_connecting = 0;
   m_success_connecting = 0;
   m_failed_connecting = 0;
+
+  m_statsFile = NULL;
+
+  m_nextRequestId = 0;
+  m_receivedRequestId = 0;
+  m_receivedConnection = NULL;
 }
 
 HttpClientApplication::~HttpClientApplication()
 {
   NS_LOG_FUNCTION (this);
-  m_socket = 0;
+  DeleteConnections();
+}
 
-  if (_tmpbuffer != NULL)
-  {
-    fprintf(stderr, "tmpbuffer is still not empty...\n");
-    free(_tmpbuffer);
-  }
+
+HttpClientApplication::Connection::Connection()
+  : connected(false), hasParsedResponseHeader(false), receiving(false), startTime(0), lastResponseTime(0),
+    downloadBitrate(0.0)
+{
 }
 
 void
 HttpClientApplication::SetRemote (Address ip, uint16_t port)
 {
   NS_LOG_FUNCTION (this << ip << port);
+  // connections to another server can not be re-used
+  if (m_peerAddress != ip || m_peerPort != port)
+  {
+    CloseConnections();
+  }
   m_peerAddress = ip;
   m_peerPort = port;
 }
@@ -138,6 +163,11 @@ void
 HttpClientApplication::SetRemote (Ipv4Address ip, uint16_t port)
 {
   NS_LOG_FUNCTION (this << ip << port);
+  // connections to another server can not be re-used
+  if (m_peerAddress != Address (ip) || m_peerPort != port)
+  {
+    CloseConnections();
+  }
   m_peerAddress = Address (ip);
   m_peerPort = port;
 }
@@ -146,6 +176,11 @@ void
 HttpClientApplication::SetRemote (Ipv6Address ip, uint16_t port)
 {
   NS_LOG_FUNCTION (this << ip << port);
+  // connections to another server can not be re-used
+  if (m_peerAddress != Address (ip) || m_peerPort != port)
+  {
+    CloseConnections();
+  }
   m_peerAddress = Address (ip);
   m_peerPort = port;
 }
@@ -154,6 +189,12 @@ void
 HttpClientApplication::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  DeleteConnections();
+  if (m_statsFile != NULL)
+  {
+    fclose(m_statsFile);
+    m_statsFile = NULL;
+  }
   Application::DoDispose ();
 }
 
@@ -176,102 +217,311 @@ HttpClientApplication::LogCwndChange(uint32_t oldCwnd, uint32_t newCwnd)
 
 
 void
-HttpClientApplication::TryEstablishConnection (void)
+HttpClientApplication::TryEstablishConnection (Connection* connection)
 {
   NS_LOG_FUNCTION (this);
 
   do_cancel_socket = false;
+  connection->connected = false;
 
+  m_tried_connecting++;
 
-  m_sentGetRequest = false;
-  m_finished_download = false;
+  // a new connection, nothing received on it yet
+  connection->responseParser.Reset();
+  connection->hasParsedResponseHeader = false;
+  connection->unparsedPacket = 0;
 
-  m_bytesRecv = 0;
-  m_bytesSent = 0;
+  TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+  Ptr<Socket> socket = Socket::CreateSocket (GetNode (), tid); //  TCP NewReno per default (according to documentation)
+  connection->socket = socket;
+  if (Ipv4Address::IsMatchingType(m_peerAddress) == true)
+  {
+    socket->Bind();
+    socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+
+    NS_LOG_DEBUG("Binding to Ipv4:" << Ipv4Address::ConvertFrom(m_peerAddress) << ":" << m_peerPort << ", errno=");
 
-  if (!m_keepAlive || m_socket == 0)
+  }
+  else if (Ipv6Address::IsMatchingType(m_peerAddress) == true)
   {
-    m_tried_connecting++;
+    socket->Bind6();
+    socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+
+    NS_LOG_DEBUG("Binding to Ipv6...");
+  }
+
+  //socket->ShutdownRecv ();
+  socket->SetConnectCallback (MakeCallback (&HttpClientApplication::ConnectionComplete, this),
+                            MakeCallback (&HttpClientApplication::ConnectionFailed, this));
+
+  socket->SetSendCallback (MakeCallback (&HttpClientApplication::OnReadySend, this));
+
+  socket->SetCloseCallbacks (MakeCallback (&HttpClientApplication::ConnectionClosedNormal, this),
+                            MakeCallback (&HttpClientApplication::ConnectionClosedError, this));
 
-    if (m_socket == 0)
+  socket->TraceConnectWithoutContext ("State",
+    MakeCallback(&HttpClientApplication::LogStateChange, this));
+
+  // UNCOMMENT in case you want CWND tracing on client (not really needed, you do not trace the CWND on the client)
+  /*
+  socket->TraceConnectWithoutContext ("CongestionWindow",
+    MakeCallback(&HttpClientApplication::LogCwndChange, this));
+  */
+
+  fprintf(stderr, "Waiting for reply from server...\n");
+}
+
+
+HttpClientApplication::Connection*
+HttpClientApplication::FindConnection (Ptr<Socket> socket) const
+{
+  for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+  {
+    if ((*it)->socket == socket)
     {
-      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
-      m_socket = Socket::CreateSocket (GetNode (), tid); //  TCP NewReno per default (according to documentation)
-      if (Ipv4Address::IsMatchingType(m_peerAddress) == true)
-      {
-        m_socket->Bind();
-        m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+      return *it;
+    }
+  }
+  return NULL;
+}
 
-        NS_LOG_DEBUG("Binding to Ipv4:" << Ipv4Address::ConvertFrom(m_peerAddress) << ":" << m_peerPort << ", errno=");
 
-      }
-      else if (Ipv6Address::IsMatchingType(m_peerAddress) == true)
+uint32_t
+HttpClientApplication::RequestFile (const std::string& fileToRequest, HttpDownloadSink::Mode downloadSinkMode)
+{
+  NS_LOG_FUNCTION (this << fileToRequest);
+
+  Request request;
+  request.requestId = ++m_nextRequestId;
+  request.fileToRequest = fileToRequest;
+  request.downloadSinkMode = downloadSinkMode;
+  request.requestTime = Simulator::Now ().GetMicroSeconds ();
+  m_requestQueue.push_back(request);
+
+  SendQueuedRequests();
+  return request.requestId;
+}
+
+
+uint32_t
+HttpClientApplication::GetNumberOfPendingRequests () const
+{
+  uint32_t pending = m_requestQueue.size();
+  for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+  {
+    pending += (*it)->sentRequests.size();
+  }
+  return pending;
+}
+
+
+void
+HttpClientApplication::SendQueuedRequests ()
+{
+  NS_LOG_FUNCTION (this);
+
+  // requests are only pipelined on connections that are kept alive
+  uint32_t maxSentRequests = m_keepAlive ? m_maxPipelinedRequests : 1;
+
+  while (!m_requestQueue.empty())
+  {
+    // the next request goes to the established connection with the fewest outstanding requests
+    Connection* connection = NULL;
+    Connection* closedConnection = NULL;
+    bool connecting = false;
+
+    for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+    {
+      Connection* c = *it;
+      if (c->socket == 0)
+      {
+        if (closedConnection == NULL)
+          closedConnection = c;
+      } else if (!c->connected)
       {
-        m_socket->Bind6();
-        m_socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+        connecting = true;
+      } else if (c->sentRequests.size() < maxSentRequests &&
+                 (connection == NULL || c->sentRequests.size() < connection->sentRequests.size()))
+      {
+        connection = c;
+      }
+    }
+
+    if (closedConnection == NULL && m_connections.size() < m_maxConnections)
+    {
+      closedConnection = new Connection();
+      m_connections.push_back(closedConnection);
+    }
 
-        NS_LOG_DEBUG("Binding to Ipv6...");
+    // rather than pipelining the request behind another one, it is sent on a further connection
+    if (connection == NULL || (!connection->sentRequests.empty() && (connecting || closedConnection != NULL)))
+    {
+      if (!connecting && closedConnection != NULL)
+      {
+        fprintf(stderr, "Establishing connection (time=%f)...\n",Simulator::Now().GetSeconds());
+        TryEstablishConnection(closedConnection);
       }
+      // the requests are sent by OnReadySend once the connection is established
+      return;
+    }
 
-      //m_socket->ShutdownRecv ();
-      m_socket->SetConnectCallback (MakeCallback (&HttpClientApplication::ConnectionComplete, this),
-                                MakeCallback (&HttpClientApplication::ConnectionFailed, this));
-    } else {
-      fprintf(stderr, "Client(%d): ERROR: m_socket != 0\n", node_id);
+    bool wasIdle = connection->sentRequests.empty();
+
+    connection->sentRequests.push_back(m_requestQueue.front());
+    m_requestQueue.pop_front();
+
+    DoSendGetRequest(connection->socket, connection->sentRequests.back().fileToRequest);
+
+    if (!connection->receiving)
+    {
+      StartReceiving(connection);
     }
 
-    m_socket->SetSendCallback (MakeCallback (&HttpClientApplication::OnReadySend, this));
+    // bytes that were received after the previous response are handled right away
+    if (wasIdle && (connection->unparsedPacket != 0 || connection->socket->GetRxAvailable() > 0))
+    {
+      Simulator::ScheduleNow(&HttpClientApplication::HandleRead, this, connection->socket);
+    }
+  }
+}
 
-    m_socket->SetCloseCallbacks (MakeCallback (&HttpClientApplication::ConnectionClosedNormal, this),
-                              MakeCallback (&HttpClientApplication::ConnectionClosedError, this));
 
-    m_socket->TraceConnectWithoutContext ("State",
-      MakeCallback(&HttpClientApplication::LogStateChange, this));
+void
+HttpClientApplication::StartReceiving (Connection* connection)
+{
+  if (connection->sentRequests.empty())
+  {
+    return;
+  }
 
-    // UNCOMMENT in case you want CWND tracing on client (not really needed, you do not trace the CWND on the client)
-    /*
-    m_socket->TraceConnectWithoutContext ("CongestionWindow",
-      MakeCallback(&HttpClientApplication::LogCwndChange, this));
-    */
+  const Request& request = connection->sentRequests.front();
 
-    fprintf(stderr, "Waiting for reply from server...\n");
+  connection->receiving = true;
+  m_finished_download = false;
+  // a pipelined response can not be received before the previous one
+  connection->startTime = std::max(request.requestTime, connection->lastResponseTime);
 
-  } else {
-    fprintf(stderr, "Keeping connection alive...\n");
-    OnReadySend(m_socket, 1200);
+  // (re)create the destination of the download
+  if (request.downloadSinkMode == HttpDownloadSink::MEMORY)
+  {
+    connection->downloadSink.OpenMemory();
+  } else if (request.downloadSinkMode == HttpDownloadSink::OUTFILE && !m_outFile.empty())
+  {
+    fprintf(stderr, "Client(%d): Creating outfile %s\n", node_id, m_outFile.c_str());
+    connection->downloadSink.OpenFile(m_outFile);
+  } else
+  {
+    connection->downloadSink.OpenDiscard();
   }
 }
 
+
 void
-HttpClientApplication::StartApplication (void)
+HttpClientApplication::RequeueSentRequests (Connection* connection)
+{
+  m_requestQueue.insert(m_requestQueue.begin(), connection->sentRequests.begin(), connection->sentRequests.end());
+  connection->sentRequests.clear();
+
+  connection->receiving = false;
+  connection->downloadSink.Close();
+}
+
+
+void
+HttpClientApplication::RetryRequests (Connection* connection)
+{
+  RequeueSentRequests(connection);
+
+  if (m_requestQueue.empty())
+  {
+    return;
+  }
+
+  // let's try sending the requests again in 0.5 second
+  m_retryEvent.Cancel();
+  m_retryEvent = Simulator::Schedule(Seconds(0.5), &HttpClientApplication::SendQueuedRequests, this);
+}
+
+
+void
+HttpClientApplication::AbortRequests ()
 {
   NS_LOG_FUNCTION (this);
 
-  // only re-init tmpbuffer if it is null
-  if (_tmpbuffer == NULL)
+  m_requestQueue.clear();
+  m_retryEvent.Cancel();
+
+  for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
   {
-    _tmpbuffer = (uint8_t*)malloc(sizeof(uint8_t)* 128*1024); // 128 kB
+    Connection* connection = *it;
+    if (!connection->sentRequests.empty())
+    {
+      connection->sentRequests.clear();
+      connection->receiving = false;
+      connection->downloadSink.Close();
+      CloseSocket(connection);
+    }
   }
+}
 
 
-  // mark this app as active
-  m_active = true;
-  _start_time = Simulator::Now ().GetMilliSeconds ();
+void
+HttpClientApplication::CloseSocket (Connection* connection)
+{
+  if (connection->socket == 0)
+  {
+    return;
+  }
+
+  connection->socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  connection->socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+  connection->socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+  connection->socket->Close ();
+  connection->socket = 0;
+  connection->connected = false;
+  connection->unparsedPacket = 0;
+}
+
 
-  // Create OutFile
-  if (!m_outFile.empty())
+void
+HttpClientApplication::CloseConnections ()
+{
+  for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
   {
-    fprintf(stderr, "Client(%d): Creating outfile %s\n", node_id, m_outFile.c_str());
-    // (re)create outfile
-    FILE* fp = fopen(m_outFile.c_str(), "w");
-    fclose(fp);
+    // the requests sent on the connection are sent again on a new one
+    RequeueSentRequests(*it);
+    CloseSocket(*it);
   }
+}
 
-  fprintf(stderr, "Establishing connection (time=%f)...\n",Simulator::Now().GetSeconds());
-  TryEstablishConnection();
 
+void
+HttpClientApplication::DeleteConnections ()
+{
+  for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+  {
+    CloseSocket(*it);
+    delete *it;
+  }
+  m_connections.clear();
+  m_receivedConnection = NULL;
+}
+
+
+void
+HttpClientApplication::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // mark this app as active
+  m_active = true;
+
+  m_bytesRecv = 0;
+  m_bytesSent = 0;
   m_lastStatsReportedBytesRecv = 0;
   m_lastStatsReportedBytesSent = 0;
+
+  RequestFile(m_fileToRequest, m_downloadSinkMode);
   // start stats reporter
   //ReportStats();
 }
@@ -286,18 +536,23 @@ HttpClientApplication::ReportStats()
   m_currentStatsTrace(this, this->m_fileToRequest, bytes_recv_last_timespan);
 
 
-  std::stringstream cwnd_trace_filename;
-  cwnd_trace_filename << "traces/cwnd_" << node_id << ".csv";
+  // opened once and kept open until the application is disposed
+  if (m_statsFile == NULL)
+  {
+    std::stringstream cwnd_trace_filename;
+    cwnd_trace_filename << "traces/cwnd_" << node_id << ".csv";
 
-  FILE* fp = fopen(cwnd_trace_filename.str().c_str(), "a");
+    m_statsFile = fopen(cwnd_trace_filename.str().c_str(), "a");
+    if (m_statsFile == NULL)
+    {
+      return;
+    }
+  }
 
-  fprintf(fp, "Client(%d):Time=%f,bytes_recv=%d,bytes_sent=%d,cwnd=%d;finished_download=%d-%ld;tried_connect=%d;failed_connect=%d;success_connect=%d\n",
+  fprintf(m_statsFile, "Client(%d):Time=%f,bytes_recv=%d,bytes_sent=%d,cwnd=%d;finished_download=%d-%ld;tried_connect=%d;failed_connect=%d;success_connect=%d\n",
       node_id, Simulator::Now().GetSeconds(), bytes_recv_last_timespan, bytes_sent_last_timespan, cur_cwnd, m_finished_download, _finished_time, m_tried_connecting, m_failed_connecting, m_success_connecting);
 
 
-          fclose(fp);
-
-
   m_lastStatsReportedBytesRecv = m_bytesRecv;
   m_lastStatsReportedBytesSent = m_bytesSent;
 
@@ -314,9 +569,36 @@ void
 HttpClientApplication::ConnectionClosedNormal (Ptr<Socket> socket)
 {
   fprintf(stderr, "Client(%d): Socket was closed normally\n", node_id);
+
   // socket is in CLOSE_WAIT state --> close the socket here --> socket will be in LAST_ACK state
   socket->Close();
   socket->SetCloseCallbacks(MakeNullCallback<void, Ptr<Socket> > (),MakeNullCallback<void, Ptr<Socket> > ());
+
+  Connection* connection = FindConnection(socket);
+  if (connection == NULL)
+  {
+    return;
+  }
+
+  // the next request needs a new connection
+  connection->socket = 0;
+  connection->connected = false;
+
+  if (connection->sentRequests.empty())
+  {
+    return;
+  }
+
+  // responses without Content-Length end when the connection is closed
+  connection->responseParser.ConnectionClosed();
+  if (connection->responseParser.IsResponseComplete())
+  {
+    OnResponseComplete(connection);
+  } else
+  {
+    fprintf(stderr, "Client(%d): Connection closed before '%s' was received, requesting it again...\n", node_id, connection->sentRequests.front().fileToRequest.c_str());
+    RetryRequests(connection);
+  }
 }
 
 
@@ -327,8 +609,17 @@ HttpClientApplication::ConnectionClosedError (Ptr<Socket> socket)
   fprintf(stderr,"Client(%d): Socket was closed with an error, errno=%d; Trying to open it again...\n", node_id, socket->GetErrno());
   socket->SetCloseCallbacks(MakeNullCallback<void, Ptr<Socket> > (),MakeNullCallback<void, Ptr<Socket> > ());
 
-  // let's try opening the second again again in 0.5 second
-  Simulator::Schedule(Seconds(0.5), &HttpClientApplication::TryEstablishConnection, this);
+  Connection* connection = FindConnection(socket);
+  if (connection == NULL)
+  {
+    return;
+  }
+
+  connection->socket = 0;
+  connection->connected = false;
+
+  // the requests of this connection are sent again on a new one
+  RetryRequests(connection);
 }
 
 
@@ -340,22 +631,29 @@ HttpClientApplication::StopApplication ()
   NS_LOG_FUNCTION (this);
 
 
-  if (_tmpbuffer != NULL)
-  {
-    free(_tmpbuffer);
-    _tmpbuffer = NULL;
-  }
-
   m_active = false;
 
-  if (m_socket != 0 && !m_keepAlive)
+  m_requestQueue.clear();
+  m_retryEvent.Cancel();
+
+  for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
   {
-    fprintf(stderr, "Client(%d): Socket is still open, closing it...\n", node_id);
-    m_socket->Close ();
-    m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
-    m_socket = 0;
-  } else {
-    fprintf(stderr, "We are in stop application, but keeping alive...\n");
+    Connection* connection = *it;
+
+    // a response that is still outstanding would be taken for the response to the next request
+    bool responseOutstanding = !connection->sentRequests.empty();
+
+    connection->sentRequests.clear();
+    connection->receiving = false;
+    connection->downloadSink.Close();
+
+    if (connection->socket != 0 && (!m_keepAlive || responseOutstanding))
+    {
+      fprintf(stderr, "Client(%d): Socket is still open, closing it...\n", node_id);
+      CloseSocket(connection);
+    } else {
+      fprintf(stderr, "We are in stop application, but keeping alive...\n");
+    }
   }
 
   Simulator::Cancel (m_reportStatsEvent);
@@ -373,9 +671,18 @@ HttpClientApplication::ConnectionComplete (Ptr<Socket> socket)
 
   m_success_connecting++;
 
+  Connection* connection = FindConnection(socket);
+  if (connection == NULL)
+  {
+    return;
+  }
+  connection->connected = true;
+
 
   // Get ready to receive.
   socket->SetRecvCallback (MakeCallback (&HttpClientApplication::HandleRead, this));
+
+  SendQueuedRequests();
 }
 
 void
@@ -388,6 +695,13 @@ HttpClientApplication::ConnectionFailed (Ptr<Socket> socket)
 
   // Well, this is not supposed to happen...
   NS_LOG_WARN ("Client failed to open connection.");
+
+  Connection* connection = FindConnection(socket);
+  if (connection != NULL)
+  {
+    CloseSocket(connection);
+    RetryRequests(connection);
+  }
 }
 
 
@@ -397,25 +711,25 @@ HttpClientApplication::OnReadySend (Ptr<Socket> localSocket, uint32_t txSpace)
 {
   NS_LOG_FUNCTION (this);
   fprintf(stderr, "HttpClientApp::OnReadySend()\n");
-  if (!m_sentGetRequest)
+  Connection* connection = FindConnection(localSocket);
+  if (connection != NULL && connection->connected)
   {
-    m_sentGetRequest = true;
-    DoSendGetRequest(localSocket, txSpace);
+    SendQueuedRequests();
   }
 }
 
 void
-HttpClientApplication::DoSendGetRequest (Ptr<Socket> localSocket, uint32_t txSpace)
+HttpClientApplication::DoSendGetRequest (Ptr<Socket> localSocket, const std::string& fileToRequest)
 {
   NS_LOG_FUNCTION (this);
 
 
-  m_downloadStartedTrace(this, this->m_fileToRequest);
+  m_downloadStartedTrace(this, fileToRequest);
 
   // Create HTTP 1.1 compatible request
   std::stringstream requestSS;
-  fprintf(stderr, "Client(%d, %f): Executing  'GET %s'\n", node_id, Simulator::Now().GetSeconds(), m_fileToRequest.c_str());
-  requestSS << "GET " << m_fileToRequest << " HTTP/1.1" << CRLF;
+  fprintf(stderr, "Client(%d, %f): Executing  'GET %s'\n", node_id, Simulator::Now().GetSeconds(), fileToRequest.c_str());
+  requestSS << "GET " << fileToRequest << " HTTP/1.1" << CRLF;
   requestSS << "Host: " << m_hostName << CRLF;
   //requestSS << "Pragma: no-cache" << CRLF;
   //requestSS << "Cache-Control: no-cache" << CRLF;
@@ -434,9 +748,6 @@ HttpClientApplication::DoSendGetRequest (Ptr<Socket> localSocket, uint32_t txSpa
   requestSS << CRLF;
 
 
-  m_is_first_packet = true;
-
-
   std::string requestString = requestSS.str();
   //fprintf(stderr, "Creating Request String:\n%s\n------------\n", requestString.c_str());
 
@@ -483,103 +794,76 @@ HttpClientApplication::CancelDownload()
 }
 
 
-uint32_t
-HttpClientApplication::ParseResponseHeader(const uint8_t* buffer, size_t len, int* realStatusCode, unsigned int* contentLength)
+void
+HttpClientApplication::OnResponseHeader(Connection* connection)
 {
-/*
-  HTTP/1.1 200 OKCRLF
-  Content-Type: text/xml; charset=utf-8CRLF
-  Content-Length: {len}CRLFCRLF;
-  */
-
-  fprintf(stderr, "Client(%d): Parsing Response Header of length %ld\n", node_id, len);
-  const char* strbuffer = (const char*) buffer;
-
-  //fprintf(stderr, "header=\n%s\n", buffer);
+  connection->hasParsedResponseHeader = true;
 
-  // should start with a HTTP response
-  if (strncmp(strbuffer, "HTTP/1.1",8) == 0)
+  const HttpResponseParser& responseParser = connection->responseParser;
+  int status_code = responseParser.GetStatusCode();
+  if (status_code == 404)
   {
-    const char* statusCode = &strbuffer[9];
-    // find next space
-    char needle[2];
-    needle[0] = ' ';
-    needle[1] = '\0';
-    const char *p = strstr(statusCode, (const char*)needle);
-    if (p)
-    {
-      int pos = p - statusCode;
+    fprintf(stderr, "Client(%d): ParseHeader: Status Code 404, not found!\n", node_id);
+  } else if (responseParser.GetContentLength() < 0 && !responseParser.IsChunked())
+  {
+    fprintf(stderr, "ERROR: Server did not reply Content-Length Header field\n");
+  }
 
-      char actualStatusCode[4];
+  // chunked responses do not announce their length, it is known when they are complete
+  requested_content_length = responseParser.GetContentLength() >= 0 ? responseParser.GetContentLength() : 0;
+  connection->downloadSink.Reserve(requested_content_length);
 
-      strncpy(actualStatusCode, statusCode,pos);
-      actualStatusCode[3] = '\0';
+  m_headerReceivedTrace(this, connection->sentRequests.front().fileToRequest, requested_content_length);
+}
 
-      int iStatusCode = atoi(actualStatusCode);
 
-      if (iStatusCode == 404)
-      {
-        fprintf(stderr, "Client(%d): ParseHeader: Status Code 404, not found!\n", node_id);
-      } else
-      {
-        // find Content-Length
-        char needle2[17];
-        strcpy(needle2, "Content-Length: ");
-        needle2[16] = '\0';
-        p = strstr(statusCode, needle2);
+void
+HttpClientApplication::OnResponseComplete(Connection* connection)
+{
+  NS_LOG_DEBUG("All bytes received, this means we are done...");
+  requested_content_length = connection->responseParser.GetBodyBytesReceived();
+  int status_code = connection->responseParser.GetStatusCode();
+  bool keepAlive = m_keepAlive && connection->responseParser.IsKeepAlive();
 
-        if (p)
-        {
-          const char* strContentLength = &statusCode[p-statusCode+16];
-
-          p = strstr(strContentLength, "\r\n");
-          if (p)
-          {
-            pos = p - strContentLength;
-            char actualContentLength[12];
-            strncpy(actualContentLength,strContentLength,pos);
-            unsigned int iActualContentLength = atoi(actualContentLength);
-
-
-            // find the end of the header, where the body content begins
-            p = strstr(strbuffer, "\r\n\r\n");
-
-            if (p)
-            {
-              // done!
-              *realStatusCode = iStatusCode;
-              *contentLength = iActualContentLength;
-
-              pos = p - strbuffer;
-              return pos+4; // +4 to skip CRLFCRLF
-            } else {
-              fprintf(stderr, "ERROR: could not find where body begins\n");
-            }
-          }
-          else
-          {
-            fprintf(stderr, "ERROR: No CRLF found?!?\n");
-          }
-
-        } else
-        {
-          fprintf(stderr, "ERROR: Server did not reply Content-Length Header field\n");
-        }
-      }
+  Request request = connection->sentRequests.front();
 
-    } else
-    {
-      fprintf(stderr, "Invalid HTTP Response, %s\n", strbuffer);
-    }
+  connection->responseParser.NextResponse();
+  connection->hasParsedResponseHeader = false;
+  connection->sentRequests.pop_front();
+  connection->receiving = false;
+  connection->lastResponseTime = Simulator::Now ().GetMicroSeconds ();
 
-  } else
+  // flush the outfile, so that it is complete when the file is handled
+  connection->downloadSink.Close();
+
+  if (!keepAlive)
   {
-    fprintf(stderr, "Not sure what this response header means\n");
-    fprintf(stderr, "Result=%s\n", strbuffer);
+    // pipelined requests are sent again on a new connection
+    m_requestQueue.insert(m_requestQueue.begin(), connection->sentRequests.begin(), connection->sentRequests.end());
+    connection->sentRequests.clear();
+    CloseSocket(connection);
   }
 
+  // the file handler sees the received file, its data and when it was started
+  m_fileToRequest = request.fileToRequest;
+  m_receivedRequestId = request.requestId;
+  m_receivedConnection = connection;
+  _start_time = connection->startTime;
+
+  // the file handler may request the next file right away
+  OnFileReceived(status_code, requested_content_length);
+
+  if (!m_active)
+  {
+    return;
+  }
 
-  return 0;
+  // the response to the next pipelined request follows, otherwise the next queued file is requested
+  if (!connection->receiving)
+  {
+    StartReceiving(connection);
+  }
+  SendQueuedRequests();
 }
 
 
@@ -595,25 +879,64 @@ HttpClientApplication::OnFileReceived(unsigned status, unsigned length)
   _finished_time = Simulator::Now().GetMilliSeconds ();
 
 
-  long milliSeconds = _finished_time - _start_time;
-  double seconds = ((double)milliSeconds)/ 1000.0;
+  int64_t microSeconds = Simulator::Now().GetMicroSeconds () - _start_time;
+  long milliSeconds = microSeconds / 1000;
+
+  if (microSeconds <= 0)
+  {
+    // a pipelined response completed in the same tick as the previous one, it does not give a bitrate
+    fprintf(stderr, "Client(%d): %s received without download time, keeping the last download bitrate\n", node_id, m_fileToRequest.c_str());
+    m_downloadFinishedTrace(this, this->m_fileToRequest, lastDownloadBitrate / 8.0, milliSeconds);
+    return;
+  }
+
+  double seconds = ((double)microSeconds)/ 1000000.0;
 
   double downloadSpeed = ((double)requested_content_length)/((double)seconds);
 
   lastDownloadBitrate = downloadSpeed * 8.0; // do not forget to do *8, as this is a BIT-rate
 
+  if (m_receivedConnection != NULL)
+  {
+    m_receivedConnection->downloadBitrate = lastDownloadBitrate;
+  }
+
   m_downloadFinishedTrace(this, this->m_fileToRequest, downloadSpeed, milliSeconds);
 }
 
 
+const std::string&
+HttpClientApplication::GetDownloadedData() const
+{
+  static const std::string noData;
+  return m_receivedConnection != NULL ? m_receivedConnection->downloadSink.GetData() : noData;
+}
+
+
+double
+HttpClientApplication::GetAggregateDownloadBitrate() const
+{
+  // parallel downloads share the bandwidth, so the bitrates of the connections that are still downloading add up
+  double bitrate = lastDownloadBitrate;
+  for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+  {
+    if (*it != m_receivedConnection && !(*it)->sentRequests.empty())
+    {
+      bitrate += (*it)->downloadBitrate;
+    }
+  }
+  return bitrate;
+}
+
+
 void
 HttpClientApplication::ForceCloseSocket()
 {
-  if (m_socket != 0)
+  if (m_keepAlive)
   {
-    if (m_keepAlive)
+    for (std::vector<Connection*>::const_iterator it = m_connections.begin(); it != m_connections.end(); ++it)
     {
-      m_socket->Close();
+      CloseSocket(*it);
     }
   }
 }
@@ -622,91 +945,127 @@ HttpClientApplication::ForceCloseSocket()
 void
 HttpClientApplication::HandleRead (Ptr<Socket> socket)
 {
-  NS_LOG_FUNCTION(this << socket << "URL=" << m_fileToRequest);
-  if (m_finished_download)
+  NS_LOG_FUNCTION(this << socket);
+  Connection* connection = FindConnection(socket);
+  if (connection == NULL)
+  {
+    return;
+  }
+
+  if (connection->sentRequests.empty())
   {
+    // the bytes are left in the socket until the next request is sent
     fprintf(stderr, "Client(%d)::HandleRead(time=%f) Client is asked to HandleRead although it should have finished already...\n", node_id, Simulator::Now().GetSeconds());
     return;
   }
 
+  // bytes received after the previous file belong to this one
+  if (connection->unparsedPacket != 0)
+  {
+    Ptr<Packet> packet = connection->unparsedPacket;
+    connection->unparsedPacket = 0;
+    if (!ParsePacket(connection, packet))
+    {
+      return;
+    }
+  }
+
   Ptr<Packet> packet;
   Address from;
 
-  uint32_t bytes_recv_this_time = 0;
-
-  while (true)
+  while ((packet = socket->RecvFrom (from)))
   {
-    packet = socket->RecvFrom (from);
-
-    if (!(packet))
+    if (!ParsePacket(connection, packet))
     {
       break;
     }
+  }
+}
 
 
-    packet->RemoveAllPacketTags ();
-    packet->RemoveAllByteTags ();
-    // PARSE PACKET
-    size_t packet_size = packet->CopyData(_tmpbuffer, packet->GetSize());
-    _tmpbuffer[packet_size] = '\0';
+bool
+HttpClientApplication::ParsePacket (Connection* connection, Ptr<Packet> packet)
+{
+  // header and chunk framing bytes are copied out of the packet in windows of this size
+  static const uint32_t headerWindow = 1024;
 
-    bytes_recv_this_time += packet_size;
+  HttpResponseParser& responseParser = connection->responseParser;
+  Ptr<Socket> socket = connection->socket;
+  uint32_t remaining = packet->GetSize();
 
-    if (m_is_first_packet)
-    {
-      m_is_first_packet = false;
-      // parse header
-      int status_code = 0;
-      int where = ParseResponseHeader(_tmpbuffer, packet_size, &status_code, &(this->requested_content_length));
-      //fprintf(stderr, "content starts at position %d, with length %d (status code %d)\n", where, requested_content_length, status_code);
-      m_bytesRecv += packet_size - where;
+  while (remaining > 0)
+  {
+    uint64_t bodyBytes = responseParser.GetBodyBytesPending();
+    uint32_t consumed;
 
-      m_headerReceivedTrace(this, this->m_fileToRequest, requested_content_length);
+    if (bodyBytes > 0)
+    {
+      // body bytes are only counted, unless the download sink keeps them
+      consumed = (uint32_t) std::min<uint64_t>(bodyBytes, remaining);
+      responseParser.ConsumeBody(consumed);
+      m_bytesRecv += consumed;
 
-      // write to file
-      if (!m_outFile.empty())
+      if (connection->downloadSink.NeedsData())
       {
-        // open outfile to append
-        FILE* fp = fopen(m_outFile.c_str(), "a");
+        if (m_recvBuffer.size() < consumed)
+          m_recvBuffer.resize(consumed);
+        packet->CopyData(&m_recvBuffer[0], consumed);
 
-        fwrite(&_tmpbuffer[where], sizeof(uint8_t), packet_size-where, fp);
-
-        fclose(fp);
+        connection->downloadSink.Write(&m_recvBuffer[0], consumed);
       }
+    } else
+    {
+      uint32_t size = std::min(remaining, headerWindow);
+      if (m_recvBuffer.size() < size)
+        m_recvBuffer.resize(size);
+      packet->CopyData(&m_recvBuffer[0], size);
 
+      consumed = responseParser.Parse(&m_recvBuffer[0], size);
 
-    } else {
-      m_bytesRecv += packet_size;
-
-      // write to file
-      if (!m_outFile.empty())
+      if (responseParser.HasError())
       {
-        // open outfile to append
-        FILE* fp = fopen(m_outFile.c_str(), "a");
-
-        fwrite(_tmpbuffer, sizeof(uint8_t), packet_size, fp);
+        fprintf(stderr, "Client(%d)::HandleRead(time=%f) Invalid HTTP Response, requesting it again on a new connection...\n", node_id, Simulator::Now().GetSeconds());
+        // the rest of the stream can't be framed anymore, so the connection is of no use
+        CloseSocket(connection);
+        RetryRequests(connection);
+        return false;
+      }
 
-        fclose(fp);
+      if (responseParser.IsHeaderComplete() && !connection->hasParsedResponseHeader)
+      {
+        OnResponseHeader(connection);
       }
     }
 
-
-    // we have received the whole file!
-    if (m_bytesRecv == requested_content_length)
+    remaining -= consumed;
+    if (remaining > 0)
     {
-      NS_LOG_DEBUG("All bytes received, this means we are done...");
-      OnFileReceived(0, requested_content_length);
-      break;
+      packet->RemoveAtStart(consumed);
     }
-    else if (m_bytesRecv > requested_content_length)
+
+    // we have received the whole file!
+    if (responseParser.IsResponseComplete())
     {
-      fprintf(stderr, "Client(%d)::HandleRead(time=%f) Expected only %d bytes, but received already %d bytes\n",
-        node_id, Simulator::Now().GetSeconds(), requested_content_length, m_bytesRecv);
-    }
+      OnResponseComplete(connection);
 
+      // the rest of the packet is only of interest if the next file is requested on this connection
+      if (connection->socket != socket)
+      {
+        return false;
+      }
+      if (connection->sentRequests.empty())
+      {
+        if (remaining > 0)
+        {
+          // keep the rest for the next request on this connection
+          connection->unparsedPacket = packet;
+        }
+        return false;
+      }
+    }
   }
 
-  //fprintf(stderr, "Client(%d)::HandleRead(time=%f) handled %d bytes this time\n", node_id, Simulator::Now().GetSeconds(), bytes_recv_this_time);
+  return true;
 }
 
 } // Namespace ns3
@@ -31,6 +31,12 @@
 #include "ns3/traced-callback.h"
 #include "ns3/tcp-socket.h"
 
+#include "http-response-parser.h"
+#include "http-download-sink.h"
+
+#include <vector>
+#include <deque>
+
 
 
 #define CRLF "\r\n"
@@ -83,6 +89,32 @@ public:
 
 
 
+  /**
+   * \brief Request a file; it is requested on the connection with the fewest outstanding requests as soon as
+   * one may be sent on it, or on a new connection if less than MaxConnections are open (or KeepAlive is not set)
+   * \param fileToRequest the path of the file on the server
+   * \param downloadSinkMode where the body of the response goes
+   * \return the id of the request, OnFileReceived sets m_receivedRequestId to it
+   */
+  uint32_t RequestFile (const std::string& fileToRequest, HttpDownloadSink::Mode downloadSinkMode);
+
+  /**
+   * \return the number of requested files that have not been received yet, including the current ones
+   */
+  uint32_t GetNumberOfPendingRequests () const;
+
+  /**
+   * \return the bitrate of the last download plus the last bitrates of the other connections that are
+   * still downloading, as parallel downloads share the bandwidth
+   */
+  double GetAggregateDownloadBitrate () const;
+
+  /**
+   * \brief Drop the current and all queued requests; as an HTTP/1.1 response can not be cancelled,
+   * the connection is closed if a response is still outstanding
+   */
+  void AbortRequests ();
+
   /**
    * \brief Forces closing the socket if KeepAlive was set
    */
@@ -100,8 +132,6 @@ protected:
   virtual void DoDispose (void);
 
   bool do_cancel_socket;
-  bool m_is_first_packet;
-  bool m_has_parsed_response_header;
 
   bool m_finished_download;
 
@@ -126,20 +156,98 @@ protected: // callbacks/traces
             unsigned int /* bytes_recv */> m_currentStatsTrace;
 
 
+  struct Request
+  {
+    uint32_t requestId;
+    std::string fileToRequest;
+    HttpDownloadSink::Mode downloadSinkMode;
+    int64_t requestTime; ///< \brief in microseconds
+  };
+
+  /**
+   * \brief A connection to the server and the responses that are received on it
+   */
+  struct Connection
+  {
+    Connection();
+
+    Ptr<Socket> socket; ///< \brief 0 if the connection is closed
+    bool connected; ///< \brief whether socket has been connected
+    HttpResponseParser responseParser;
+    bool hasParsedResponseHeader;
+    HttpDownloadSink downloadSink;
+    std::deque<Request> sentRequests; ///< \brief requests sent on socket, in the order of their responses
+    bool receiving; ///< \brief whether the download sink is open for the first sent request
+    int64_t startTime; ///< \brief when the response to the first sent request started, in microseconds
+    int64_t lastResponseTime; ///< \brief when the last response was received completely, in microseconds
+    double downloadBitrate; ///< \brief bitrate of the last response received on this connection
+    Ptr<Packet> unparsedPacket; ///< \brief bytes received after the end of the last requested file
+  };
+
   void ConnectionComplete (Ptr<Socket> socket);
   void ConnectionFailed (Ptr<Socket> socket);
   void ConnectionClosedNormal (Ptr<Socket> socket);
   void ConnectionClosedError (Ptr<Socket> socket);
 
-  void TryEstablishConnection();
+  void TryEstablishConnection(Connection* connection);
+
+  /**
+   * \return the connection of socket, NULL if it is not (or no longer) used
+   */
+  Connection* FindConnection(Ptr<Socket> socket) const;
+
+  /**
+   * \brief Send queued requests, as many as may be pipelined on the connections, opening new connections as needed
+   */
+  void SendQueuedRequests();
+
+  /**
+   * \brief Open the download sink for the first request sent on connection, whose response is received next
+   */
+  void StartReceiving(Connection* connection);
+
+  /**
+   * \brief Put the requests sent on connection back to the front of the queue, their responses will not be received
+   */
+  void RequeueSentRequests(Connection* connection);
+
+  /**
+   * \brief Requeue the requests sent on connection and send them again on a new connection
+   */
+  void RetryRequests(Connection* connection);
+
+  /**
+   * \brief Close the socket of connection without waiting for any callbacks
+   */
+  void CloseSocket(Connection* connection);
+
+  /**
+   * \brief Close all connections, their sent requests are requeued
+   */
+  void CloseConnections();
+
+  void DeleteConnections();
 
   virtual void OnFileReceived(unsigned status, unsigned length);
 
 
   void ReportStats();
 
+  /**
+   * \brief The file downloaded last, if it was requested with the Memory download sink
+   */
+  const std::string& GetDownloadedData() const;
 
-  uint32_t ParseResponseHeader (const uint8_t* buffer, size_t len, int* statusCode, unsigned int* contentLength);
+
+  /**
+   * \brief Called when the response parser has parsed a whole header
+   */
+  void OnResponseHeader (Connection* connection);
+
+  /**
+   * \brief Called when the response parser has parsed a whole response
+   */
+  void OnResponseComplete (Connection* connection);
 
   void LogStateChange(const  ns3::TcpSocket::TcpStates_t old_state, const  ns3::TcpSocket::TcpStates_t new_state);
 
@@ -150,6 +258,7 @@ protected: // callbacks/traces
 
 
   std::string m_fileToRequest;
+  uint32_t m_receivedRequestId; ///< \brief id of the request whose file was received last
   std::string m_hostName; //!< The hostname of the destiatnion server
   std::string m_outFile;
 
@@ -159,7 +268,19 @@ protected: // callbacks/traces
 
 private:
 
-  uint8_t* _tmpbuffer;
+  std::deque<Request> m_requestQueue; ///< \brief files that have not been requested yet
+  uint32_t m_nextRequestId;
+  uint32_t m_maxPipelinedRequests; ///< \brief maximum number of requests sent on a KeepAlive connection
+  uint32_t m_maxConnections; ///< \brief maximum number of parallel connections
+  std::vector<Connection*> m_connections;
+  Connection* m_receivedConnection; ///< \brief connection on which the file was received last
+  EventId m_retryEvent; ///< \brief Event to send the requests of a closed connection again
+
+  std::vector<uint8_t> m_recvBuffer; ///< \brief header bytes (and body bytes kept by the download sink) are copied here
+
+  HttpDownloadSink::Mode m_downloadSinkMode;
+
+  FILE* m_statsFile; ///< \brief traces/cwnd_<node_id>.csv written by ReportStats
 
   /**
    * \brief Callback from Socket when ready to send a packet
@@ -170,7 +291,7 @@ private:
   /**
    * \brief Sending an actual packet
    */
-  virtual void DoSendGetRequest (Ptr<Socket> localSocket, uint32_t txSpace);
+  virtual void DoSendGetRequest (Ptr<Socket> localSocket, const std::string& fileToRequest);
 
   /**
    * \brief Handle a packet reception.
@@ -181,11 +302,16 @@ private:
    */
   void HandleRead (Ptr<Socket> socket);
 
+  /**
+   * \brief Parse the received packet, only header and chunk framing bytes are copied out of it
+   * \return false if the requested file has been received before the end of the packet, or if the response is invalid and the connection has been closed
+   */
+  bool ParsePacket (Connection* connection, Ptr<Packet> packet);
+
   Time m_interval; //!< Packet inter-send time
   uint32_t m_size; //!< Size of the sent packet
 
   uint32_t m_sent; //!< Counter for sent packets
-  Ptr<Socket> m_socket; //!< Socket
   Address m_peerAddress; //!< Remote peer address
   uint16_t m_peerPort; //!< Remote peer port
   EventId m_sendEvent; //!< Event to send the next packet
@@ -198,16 +324,14 @@ private:
   uint32_t m_lastStatsReportedBytesRecv;
   uint32_t m_lastStatsReportedBytesSent;
 
-  bool m_sentGetRequest; //!< Indicates whether a GET request has been sent yet or not
-
 
   /// Callbacks for tracing the packet Tx events
   TracedCallback<Ptr<const Packet> > m_txTrace;
 
 
 
-  int64_t _start_time;
-  int64_t _finished_time;
+  int64_t _start_time; ///< \brief when the download of the received file started, in microseconds
+  int64_t _finished_time; ///< \brief when the last file was received, in milliseconds
 
   uint32_t m_tried_connecting;
   uint32_t m_success_connecting;
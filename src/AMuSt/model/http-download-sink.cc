@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Destination of the files downloaded by the HTTP client
+
+#include "http-download-sink.h"
+
+
+namespace ns3
+{
+
+HttpDownloadSink::HttpDownloadSink() : m_mode(DISCARD), m_file(NULL)
+{
+}
+
+
+HttpDownloadSink::~HttpDownloadSink()
+{
+  Close();
+}
+
+
+void
+HttpDownloadSink::OpenDiscard()
+{
+  Close();
+  m_mode = DISCARD;
+  m_data.clear();
+}
+
+
+void
+HttpDownloadSink::OpenMemory()
+{
+  Close();
+  m_mode = MEMORY;
+  m_data.clear();
+}
+
+
+bool
+HttpDownloadSink::OpenFile(const std::string& path, size_t bufferSize)
+{
+  OpenDiscard();
+
+  m_file = fopen(path.c_str(), "wb");
+  if (m_file == NULL)
+  {
+    fprintf(stderr, "Error: could not create outfile '%s'\n", path.c_str());
+    return false;
+  }
+
+  // let stdio allocate a buffer of bufferSize bytes
+  setvbuf(m_file, NULL, _IOFBF, bufferSize);
+  m_mode = OUTFILE;
+  return true;
+}
+
+
+void
+HttpDownloadSink::Close()
+{
+  if (m_file != NULL)
+  {
+    fclose(m_file);
+    m_file = NULL;
+  }
+}
+
+
+HttpDownloadSink::Mode
+HttpDownloadSink::GetMode() const
+{
+  return m_mode;
+}
+
+
+bool
+HttpDownloadSink::NeedsData() const
+{
+  return m_mode == MEMORY || (m_mode == OUTFILE && m_file != NULL);
+}
+
+
+void
+HttpDownloadSink::Reserve(size_t size)
+{
+  if (m_mode == MEMORY)
+  {
+    m_data.reserve(m_data.size() + size);
+  }
+}
+
+
+void
+HttpDownloadSink::Write(const uint8_t* data, size_t size)
+{
+  if (m_mode == MEMORY)
+  {
+    m_data.append((const char*) data, size);
+  } else if (m_mode == OUTFILE && m_file != NULL)
+  {
+    fwrite(data, sizeof(uint8_t), size, m_file);
+  }
+}
+
+
+const std::string&
+HttpDownloadSink::GetData() const
+{
+  return m_data;
+}
+
+} // namespace ns3
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Destination of the files downloaded by the HTTP client
+
+
+#ifndef HTTP_DOWNLOAD_SINK_H
+#define HTTP_DOWNLOAD_SINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+
+
+namespace ns3
+{
+
+/**
+ * \brief Destination of the body of a download
+ *
+ * A sink either discards the body (the client only counts the bytes, e.g., for media segments), keeps it
+ * in memory (e.g., for the MPD), or writes it to a file through a stdio buffer of bufferSize bytes, which
+ * is opened once per download and flushed when the download is closed.
+ */
+class HttpDownloadSink
+{
+public:
+  enum Mode
+  {
+    DISCARD,
+    MEMORY,
+    OUTFILE
+  };
+
+  HttpDownloadSink();
+  ~HttpDownloadSink();
+
+  void OpenDiscard();
+  void OpenMemory();
+
+  /**
+   * \brief (Re)create path and write the download to it
+   * \return false if the file can not be created, the sink discards the download then
+   */
+  bool OpenFile(const std::string& path, size_t bufferSize = 65536);
+
+  /**
+   * \brief Flush and close the file, the data kept in memory stays available
+   */
+  void Close();
+
+  Mode GetMode() const;
+
+  /**
+   * \return whether Write has to be called with the body, i.e., the sink does not discard it
+   */
+  bool NeedsData() const;
+
+  /**
+   * \brief Hint about the size of the body, e.g., from the Content-Length header
+   */
+  void Reserve(size_t size);
+
+  void Write(const uint8_t* data, size_t size);
+
+  /**
+   * \return the data written to a MEMORY sink
+   */
+  const std::string& GetData() const;
+
+protected:
+  Mode m_mode;
+  FILE* m_file;
+  std::string m_data;
+};
+
+} // namespace ns3
+
+
+#endif /* HTTP_DOWNLOAD_SINK_H */
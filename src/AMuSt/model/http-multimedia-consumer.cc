@@ -23,7 +23,10 @@
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/core-module.h"
+
+#include "mpd-cache.h"
 #include "ns3/trace-source-accessor.h"
 
 
@@ -38,8 +41,6 @@ typedef MultimediaConsumer<HttpClientApplication> HTTPMultimediaConsumer;
 NS_OBJECT_ENSURE_REGISTERED(HTTPMultimediaConsumer);
 
 
-template <typename Parent> std::string MultimediaConsumer<Parent>::alphabet = std::string("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890");
-
 template<class Parent>
 TypeId
 MultimediaConsumer<Parent>::GetTypeId(void)
@@ -57,6 +58,10 @@ MultimediaConsumer<Parent>::GetTypeId(void)
                     MakeUintegerAccessor(&MultimediaConsumer<Parent>::m_screenHeight), MakeUintegerChecker<uint32_t>())
       .template AddAttribute("MaxBufferedSeconds", "Maximum amount of buffered seconds allowed", UintegerValue(30),
                     MakeUintegerAccessor(&MultimediaConsumer<Parent>::m_maxBufferedSeconds), MakeUintegerChecker<uint32_t>())
+      .template AddAttribute("PrefetchDepth", "Maximum number of segments that are requested (pipelined) before they are received", UintegerValue(1),
+                    MakeUintegerAccessor(&MultimediaConsumer<Parent>::m_prefetchDepth), MakeUintegerChecker<uint32_t>(1))
+      .template AddAttribute("ParallelConnections", "Number of connections that consecutive segments are downloaded on in parallel", UintegerValue(1),
+                    MakeUintegerAccessor(&MultimediaConsumer<Parent>::m_parallelConnections), MakeUintegerChecker<uint32_t>(1))
       .template AddAttribute("DeviceType", "PC, Laptop, Tablet, Phone, Game Console", StringValue("PC"),
                     MakeStringAccessor(&MultimediaConsumer<Parent>::m_deviceType), MakeStringChecker())
       .template AddAttribute("AllowUpscale", "Define whether or not the client has capabilities to upscale content with lower resolutions", BooleanValue(true),
@@ -133,28 +138,19 @@ MultimediaConsumer<Parent>::StartApplication() // Called at time specified by St
   }
 
 
-  std::stringstream ss_tempDir;
-  ss_tempDir << "-ns3-node-" << super::node_id ;
-
-  for(int i = 0; i < 8; ++i)
-     ss_tempDir << MultimediaConsumer<Parent>::alphabet[rand()%MultimediaConsumer<Parent>::alphabet.size()];
-
-  m_tempDir = ns3::SystemPath::MakeTemporaryDirectoryName() + ss_tempDir.str();
-
-  NS_LOG_DEBUG("Client(" << super::node_id << "): Temporary Directory: " << m_tempDir);
-  ns3::SystemPath::MakeDirectories(m_tempDir);
-
-  m_tempMpdFile = m_tempDir + "/mpd.xml.gz";
-
   m_mpdParsed = false;
   m_initSegmentIsGlobal = false;
   m_hasInitSegment = false;
   m_hasDownloadedAllSegments = false;
+  m_hasRequestedAllSegments = false;
   m_hasStartedPlaying = false;
   m_freezeStartTime = 0;
+  m_playerWaiting = false;
+  m_downloaderWaiting = false;
   totalConsumedSegments = 0;
   requestedRepresentation = NULL;
   requestedSegmentURL = NULL;
+  m_requestedSegments.clear();
 
   m_currentDownloadType = MPD;
   m_startTime = Simulator::Now().GetMilliSeconds();
@@ -167,8 +163,12 @@ MultimediaConsumer<Parent>::StartApplication() // Called at time specified by St
           "Could not initialize adaptation logic...");
 
   super::SetAttribute("FileToRequest", StringValue(mpd_request_name));
-  super::SetAttribute("WriteOutfile", StringValue(m_tempMpdFile));
+  // the MPD is kept in memory and parsed from there
+  super::SetAttribute("WriteOutfile", StringValue(""));
+  super::SetAttribute("DownloadSink", EnumValue(HttpDownloadSink::MEMORY));
   super::SetAttribute("KeepAlive", StringValue("true"));
+  super::SetAttribute("MaxPipelinedRequests", UintegerValue(m_prefetchDepth));
+  super::SetAttribute("MaxConnections", UintegerValue(m_parallelConnections));
 
   // do base stuff
   super::StartApplication();
@@ -192,6 +192,9 @@ MultimediaConsumer<Parent>::StopApplication() // Called at time specified by Sto
   m_downloadEventTimer.Cancel();
   Simulator::Cancel(m_downloadEventTimer);
 
+  m_playerWaiting = false;
+  m_downloaderWaiting = false;
+
   /*OK LOG ALL NOT RECEIVED FILES FROM MPD*/
   if(traceNotDownloadedSegments)
   {
@@ -210,12 +213,8 @@ MultimediaConsumer<Parent>::StopApplication() // Called at time specified by Sto
     }
   }
 
-  // clean up mpd/DASH specific stuff
-  if (mpd != NULL)
-  {
-    delete mpd;
-    mpd = NULL;
-  }
+  // clean up mpd/DASH specific stuff, the mpd itself is owned by MpdCache
+  mpd = NULL;
 
   if (mPlayer != NULL)
   {
@@ -237,76 +236,18 @@ MultimediaConsumer<Parent>::StopApplication() // Called at time specified by Sto
 
 
 
-template<class Parent>
-bool
-MultimediaConsumer<Parent>::DecompressFile ( std::string source, std::string filename )
-{
-  NS_LOG_FUNCTION(source << filename);
-  std::ifstream infile( source.c_str(), std::ios_base::in | std::ios_base::binary ); //Creates the input stream
-  //Tests if the file is being opened correctly.
-  if ( !infile )
-  {
-   std::cerr<< "Can't open file: " << source << std::endl;
-   return false;
-  }
-
-  // read
-  std::string compressed_str((std::istreambuf_iterator<char>(infile)),
-                 std::istreambuf_iterator<char>());
-
-  try
-  {
-    std::string decompressed = zlib_decompress_string(compressed_str);
-
-    std::ofstream outfile( filename.c_str(), std::ios_base::out |  std::ios_base::binary ); //Creates the output stream
-    outfile << decompressed;
-    outfile.close();
-  }
-  catch(std::exception& e)
-  {
-    //std::cerr << e.what() << std::endl;
-    NS_LOG_DEBUG(e.what() << " Assuming file was not zipped!");
-    return false;
-  }
-
-
-  return true;
-}
-
-
 template<class Parent>
 void
 MultimediaConsumer<Parent>::OnMpdFile()
 {
   fprintf(stderr, "Client(%d): On MPD File...\n", super::node_id);
 
-  // check if file was gziped, if not, we use it as is
-  if (m_tempMpdFile.find(".gz") != std::string::npos)
-  {
-    // file was compressed, decompress it
-    NS_LOG_DEBUG("GZIP MPD File " << m_tempMpdFile << " received. Decompressing...");
-    std::string newFileName = m_tempMpdFile.substr(0, m_tempMpdFile.find(".gz"));
-
-    // TODO DECOMPRESS
-    if(DecompressFile(m_tempMpdFile, newFileName))
-      m_tempMpdFile = newFileName;
-  }
-
-
-  NS_LOG_DEBUG("MPD File " << m_tempMpdFile << " received. Parsing now...");
-
-
-  dash::IDASHManager *manager;
-  manager = CreateDashManager();
-  mpd = manager->Open((char*)m_tempMpdFile.c_str());
-
-  // We don't need the manager anymore...
-  manager->Delete();
-  manager = NULL;
+  // the MPD was downloaded into memory, every distinct MPD is only decompressed and parsed once for all clients
+  mpd = MpdCache::Get(super::GetDownloadedData());
 
   if (mpd == NULL)
   {
-    NS_LOG_ERROR("Error parsing mpd " << m_tempMpdFile);
+    NS_LOG_ERROR("Error parsing mpd " << super::m_fileToRequest);
     return;
   }
 
@@ -544,13 +485,6 @@ MultimediaConsumer<Parent>::OnMpdFile()
 
   // we received the MDP, so we can now start the timer for playing
   SchedulePlay(startupDelay);
-
-  /* also we can delete the folder (m_tempDir) the MPD is stored in */
-  std::string rmdir_cmd = "rm -rf " + m_tempDir;
-  if (system(rmdir_cmd.c_str()) != 0)
-  {
-    fprintf(stderr, "Error: could not delete directory '%s'.\n", m_tempDir.c_str());
-  }
 }
 
 
@@ -585,23 +519,27 @@ MultimediaConsumer<Parent>::OnMultimediaFile()
     // normal segment
 
     //fprintf(stderr, "lastBitrate = %f\n", super::lastDownloadBitrate);
-    mPlayer->SetLastDownloadBitRate(super::lastDownloadBitrate);
+    // with parallel connections, the segments that are still downloaded share the bandwidth
+    mPlayer->SetLastDownloadBitRate(super::GetAggregateDownloadBitrate());
 
     fprintf(stderr, "Last Download Speed = %f kBit/s\n", super::lastDownloadBitrate/1000.0);
 
+    // responses on different connections are not necessarily received in the order of the requests
+    typename std::deque<RequestedSegment>::iterator it = m_requestedSegments.begin();
+    while (it != m_requestedSegments.end() && it->requestId != super::m_receivedRequestId)
+      ++it;
 
-    // check if there is enough space in buffer
-    if(mPlayer->EnoughSpaceInBuffer(requestedSegmentNr, requestedRepresentation, m_isLayeredContent))
+    if (it == m_requestedSegments.end())
     {
-      if(mPlayer->AddToBuffer(requestedSegmentNr, requestedRepresentation, super::lastDownloadBitrate, m_isLayeredContent))
-        NS_LOG_DEBUG("Segment Accepted for Buffering");
-      else
-        NS_LOG_DEBUG("Segment Rejected for Buffering");
+      NS_LOG_ERROR("Client(" << super::node_id << "): Received a segment that was not requested");
+      return;
     }
-    else
+
+    it->received = true;
+    it->downloadBitrate = super::lastDownloadBitrate;
+
+    if (!BufferReceivedSegments())
     {
-      // try again in 1 second, and again and again... but do not donwload anything in the meantime
-      Simulator::Schedule(Seconds(1.0), &MultimediaConsumer<Parent>::OnMultimediaFile, this);
       return;
     }
   }
@@ -612,6 +550,93 @@ MultimediaConsumer<Parent>::OnMultimediaFile()
 }
 
 
+template<class Parent>
+bool
+MultimediaConsumer<Parent>::BufferReceivedSegments()
+{
+  bool buffered = false;
+
+  // segments are added to the buffer in the order of their requests
+  while (!m_requestedSegments.empty() && m_requestedSegments.front().received)
+  {
+    const RequestedSegment& segment = m_requestedSegments.front();
+
+    // check if there is enough space in buffer
+    if (!mPlayer->EnoughSpaceInBuffer(segment.segmentNr, segment.representation, m_isLayeredContent))
+    {
+      // try again when the player has consumed a segment, but do not donwload anything in the meantime
+      m_downloaderWaiting = true;
+      break;
+    }
+
+    if(mPlayer->AddToBuffer(segment.segmentNr, segment.representation, segment.downloadBitrate, m_isLayeredContent))
+    {
+      NS_LOG_DEBUG("Segment Accepted for Buffering");
+      buffered = true;
+    }
+    else
+      NS_LOG_DEBUG("Segment Rejected for Buffering");
+
+    m_requestedSegments.pop_front();
+  }
+
+  if (buffered)
+  {
+    WakePlayer();
+  }
+
+  return m_requestedSegments.empty() || !m_requestedSegments.front().received;
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::RetryBufferReceivedSegments()
+{
+  if (!super::m_active)
+    return;
+
+  if (BufferReceivedSegments())
+  {
+    ScheduleDownloadOfSegment();
+  }
+}
+
+
+template<class Parent>
+double
+MultimediaConsumer<Parent>::GetSegmentDuration(const IRepresentation* representation)
+{
+  const ISegmentList* segmentList = representation->GetSegmentList();
+  if (segmentList == NULL)
+    return 0.0;
+
+  uint32_t timescale = segmentList->GetTimescale() > 0 ? segmentList->GetTimescale() : 1;
+  return ((double)segmentList->GetDuration()) / ((double)timescale);
+}
+
+
+template<class Parent>
+bool
+MultimediaConsumer<Parent>::HasBufferSpaceForPrefetch()
+{
+  // the requested segments are not in the buffer yet, but they will be; layers of a segment share its duration
+  double requestedSeconds = 0.0;
+  unsigned int lastSegmentNr = 0;
+  for (typename std::deque<RequestedSegment>::const_iterator it = m_requestedSegments.begin(); it != m_requestedSegments.end(); ++it)
+  {
+    if (it == m_requestedSegments.begin() || it->segmentNr != lastSegmentNr)
+      requestedSeconds += GetSegmentDuration(it->representation);
+    lastSegmentNr = it->segmentNr;
+  }
+
+  // the next segment is assumed to be as long as the last requested one
+  double nextSeconds = m_requestedSegments.empty() ? 0.0 : GetSegmentDuration(m_requestedSegments.back().representation);
+
+  return mPlayer->GetBufferLevel() + requestedSeconds + nextSeconds <= m_maxBufferedSeconds;
+}
+
+
 template<class Parent>
 void
 MultimediaConsumer<Parent>::OnFileReceived(unsigned status, unsigned length)
@@ -650,10 +675,7 @@ void
 MultimediaConsumer<Parent>::DownloadInitSegment()
 {
   NS_LOG_DEBUG("Downloading init segment... " << m_baseURL + m_initSegment << ";");
-  super::StopApplication();
-  super::SetAttribute("FileToRequest", StringValue(m_baseURL + m_initSegment));
-  super::SetAttribute("WriteOutfile", StringValue(""));
-  super::StartApplication();
+  super::RequestFile(m_baseURL + m_initSegment, HttpDownloadSink::DISCARD);
 }
 
 
@@ -662,10 +684,9 @@ template<class Parent>
 void
 MultimediaConsumer<Parent>::ScheduleDownloadOfSegment()
 {
-  // wait 1 ms (dummy time) before downloading next segment - this prevents some issues
-  // with start/stop application and interests coming in late.
+  // the next segment is requested right away on the current connection
   m_downloadEventTimer.Cancel();
-  m_downloadEventTimer = Simulator::Schedule(Seconds(0.001), &MultimediaConsumer<Parent>::DownloadSegment, this);
+  DownloadSegment();
 }
 
 
@@ -684,31 +705,65 @@ MultimediaConsumer<Parent>::DownloadSegment()
     return;
   }*/
 
-  // get segment number and rep id
-  requestedRepresentation = NULL;
-  requestedSegmentNr = 0;
-
-  requestedSegmentURL = mPlayer->GetAdaptationLogic()->GetNextSegment(&requestedSegmentNr, &requestedRepresentation, &m_hasDownloadedAllSegments);
   fprintf(stderr, "Multimediaconsumer::Downloadsegment()\n");
-  if(m_hasDownloadedAllSegments) // DONE
+
+  // segments that do not fit into the buffer yet block further downloads
+  if (!m_requestedSegments.empty() && m_requestedSegments.front().received)
+    return;
+
+  // request up to m_prefetchDepth segments per connection, they are spread over the connections and pipelined on them
+  while (!m_hasRequestedAllSegments && m_requestedSegments.size() < m_prefetchDepth * m_parallelConnections)
+  {
+    // segments after the one being downloaded are only requested if the buffer can hold them
+    if (!m_requestedSegments.empty() && !HasBufferSpaceForPrefetch())
+      break;
+
+    // get segment number and rep id
+    requestedRepresentation = NULL;
+    requestedSegmentNr = 0;
+
+    requestedSegmentURL = mPlayer->GetAdaptationLogic()->GetNextSegment(&requestedSegmentNr, &requestedRepresentation, &m_hasRequestedAllSegments);
+    if (m_hasRequestedAllSegments)
+      break;
+
+    if (requestedSegmentURL == NULL) //IDLE
+    {
+      // with segments outstanding, we ask again once the next one has been received
+      if (m_requestedSegments.empty())
+      {
+        NS_LOG_DEBUG("IDLE\n");
+        if (mPlayer->GetBufferLevel() > 0)
+        {
+          // the adaptation logic decides on the buffer level, so we ask again when the player has consumed a segment
+          m_downloaderWaiting = true;
+        } else
+        {
+          // nothing will be consumed, so there is nothing to wait for
+          m_downloadEventTimer = Simulator::Schedule(Seconds(1.0), &MultimediaConsumer<Parent>::DownloadSegment, this);
+        }
+      }
+      return;
+    }
+
+    RequestedSegment segment;
+    segment.segmentNr = requestedSegmentNr;
+    segment.representation = requestedRepresentation;
+    segment.downloadBitrate = 0.0;
+    segment.received = false;
+    segment.requestId = super::RequestFile(m_baseURL + requestedSegmentURL->GetMediaURI(), HttpDownloadSink::DISCARD);
+    m_requestedSegments.push_back(segment);
+  }
+
+  if (m_hasRequestedAllSegments && m_requestedSegments.empty()) // DONE
   {
     NS_LOG_DEBUG("No more segments available for download!\n");
+    m_hasDownloadedAllSegments = true;
     // make sure to close the socket
     super::ForceCloseSocket();
-    return;
-  }
 
-  if (requestedSegmentURL == NULL) //IDLE
-  {
-    NS_LOG_DEBUG("IDLE\n");
-    m_downloadEventTimer = Simulator::Schedule(Seconds(1.0), &MultimediaConsumer<Parent>::DownloadSegment, this);
-    return;
+    // a stalled player finishes now
+    WakePlayer();
   }
-
-  super::StopApplication();
-  super::SetAttribute("FileToRequest", StringValue(m_baseURL + requestedSegmentURL->GetMediaURI()));
-  super::SetAttribute("WriteOutfile", StringValue(""));
-  super::StartApplication();
 }
 
 
@@ -734,6 +789,9 @@ MultimediaConsumer<Parent>::DoPlay()
   if(consumed_sec > 0) // we play
   {
     SchedulePlay(consumed_sec);
+
+    // there is space in the buffer now
+    WakeDownloader();
   }
   else if(consumed_sec == 0.0 && m_hasDownloadedAllSegments)
   {
@@ -742,18 +800,20 @@ MultimediaConsumer<Parent>::DoPlay()
   }
   else //we stall
   {
-     //restart timer
-     SchedulePlay(); // with default parm.
+    // continue playing when the next segment is added to the buffer
+    m_playerWaiting = true;
 
     //check if we should abort the download
-    if(requestedRepresentation != NULL && !m_hasDownloadedAllSegments && requestedRepresentation->GetDependencyId().size() > 0) // means we are downloading something with dependencies
+    const IRepresentation* downloadingRepresentation = m_requestedSegments.empty() ? NULL : m_requestedSegments.front().representation;
+    if(downloadingRepresentation != NULL && !m_hasDownloadedAllSegments && downloadingRepresentation->GetDependencyId().size() > 0) // means we are downloading something with dependencies
     {
       //check buffer state
-      if(!mPlayer->GetAdaptationLogic()->hasMinBufferLevel(requestedRepresentation))
+      if(!mPlayer->GetAdaptationLogic()->hasMinBufferLevel(downloadingRepresentation))
       {
-        //abort download ...
-        NS_LOG_DEBUG("Aborting to download a segment with repId = " << requestedRepresentation->GetId().c_str());
-        super::StopApplication();
+        //abort download (and all prefetched segments) ...
+        NS_LOG_DEBUG("Aborting to download a segment with repId = " << downloadingRepresentation->GetId().c_str());
+        super::AbortRequests();
+        m_requestedSegments.clear();
         mPlayer->SetLastDownloadBitRate(0.0);//set dl_bitrate to zero.
         ScheduleDownloadOfSegment();
       }
@@ -761,6 +821,32 @@ MultimediaConsumer<Parent>::DoPlay()
   }
 }
 
+template<class Parent>
+void
+MultimediaConsumer<Parent>::WakePlayer()
+{
+  if (!m_playerWaiting)
+    return;
+
+  m_playerWaiting = false;
+  // play after the current event, e.g., after the segment that was received has been handled completely
+  SchedulePlay(0.0);
+}
+
+
+template<class Parent>
+void
+MultimediaConsumer<Parent>::WakeDownloader()
+{
+  if (!m_downloaderWaiting || m_hasDownloadedAllSegments)
+    return;
+
+  m_downloaderWaiting = false;
+  m_downloadEventTimer.Cancel();
+  RetryBufferReceivedSegments();
+}
+
+
 template<class Parent>
 double
 MultimediaConsumer<Parent>::consume()
@@ -45,10 +45,11 @@
 
 #include "libdash.h"
 
+#include <deque>
+
 #include "multimedia-player.h"
 
 
-#define MULTIMEDIA_CONSUMER_LOOP_TIMER 0.1
 #define MIN_BUFFER_LEVEL 4.0
 
 
@@ -90,9 +91,6 @@ protected:
   virtual void
   OnFileReceived(unsigned status, unsigned length);
 
-  bool
-  DecompressFile ( std::string source, std::string filename );
-
   std::string m_mpdUrl;     ///< \brief http URL of the MPD
   unsigned int m_screenWidth; ///< \brief The spatial width of the simulated screen
   unsigned int m_screenHeight; ///< \brief The spatial height of the simulated screen
@@ -100,17 +98,16 @@ protected:
   bool m_allowUpscale;        ///< \brief Whether or not it is possible to upscale content with lower resolutions to the screen width/height
   bool m_allowDownscale;      ///< \brief Whether or not it is possible to downscale content with higher resolutions to the screen width/height
   unsigned int m_maxBufferedSeconds; ///< \brief The maximum amount of buffered seconds
+  unsigned int m_prefetchDepth; ///< \brief The maximum number of segments requested before they are received
+  unsigned int m_parallelConnections; ///< \brief The number of connections segments are downloaded on in parallel
   double startupDelay;
 
   std::string m_startRepresentationId;  ///< \brief The representation ID for initializing streaming
   std::string m_adaptationLogicStr;     ///< \brief The adaptation logic that should be used
 
 
-  std::string m_tempDir; ///< \brief a temporary directory for storing and parsing the downloaded mpd file
-  std::string m_tempMpdFile; ///< \brief path to the temporary MPD file
-
 
-  dash::mpd::IMPD *mpd; ///< \brief Pointer to the MPD
+  const dash::mpd::IMPD *mpd; ///< \brief Pointer to the MPD, shared with other consumers through MpdCache
   dash::player::MultimediaPlayer *mPlayer;
 
   std::map<std::string, IRepresentation*> m_availableRepresentations; ///< \brief a map with available representations
@@ -127,8 +124,6 @@ protected:
 
   uint32_t m_userId;
 
-  static std::string alphabet;
-
   bool m_mpdParsed;
   bool m_initSegmentIsGlobal;
   bool m_hasInitSegment;
@@ -137,19 +132,45 @@ protected:
   bool traceNotDownloadedSegments;
   unsigned int totalConsumedSegments;
 
+  bool m_hasRequestedAllSegments;
+
   dash::mpd::ISegmentURL* requestedSegmentURL;
   const dash::mpd::IRepresentation* requestedRepresentation;
   unsigned int requestedSegmentNr;
 
+  struct RequestedSegment
+  {
+    uint32_t requestId;
+    unsigned int segmentNr;
+    const dash::mpd::IRepresentation* representation;
+    double downloadBitrate;
+    bool received;
+  };
+
+  std::deque<RequestedSegment> m_requestedSegments; ///< \brief segments requested but not added to the buffer yet, in the order of the requests
 
 
-  void SchedulePlay(double wait_time = MULTIMEDIA_CONSUMER_LOOP_TIMER);
+
+  void SchedulePlay(double wait_time);
   void DoPlay();
   double consume();
 
+  /**
+   * \brief Resume playing after a stall, called when a segment was added to the buffer
+   */
+  void WakePlayer();
+
+  /**
+   * \brief Resume buffering and downloading, called when the player consumed a segment from the buffer
+   */
+  void WakeDownloader();
+
   EventId m_consumerLoopTimer;
   EventId m_downloadEventTimer;
 
+  bool m_playerWaiting;     ///< \brief the player stalls until a segment is added to the buffer
+  bool m_downloaderWaiting; ///< \brief buffering and downloading wait until the player consumes a segment
+
   std::vector<std::string> m_downloadedInitSegments; ///< \brief a vector containing the representation IDs of which we have init segments
   DownloadType m_currentDownloadType;
 
@@ -172,6 +193,21 @@ protected:
   virtual void
   DownloadSegment();
 
+  /**
+   * \brief Add the received segments to the buffer in the order of their requests, if there is enough space in the buffer
+   * \return false if a segment could not be buffered yet, adding it is retried when the player consumes a segment then
+   */
+  bool BufferReceivedSegments();
+
+  void RetryBufferReceivedSegments();
+
+  /**
+   * \return whether the buffer has room for another segment besides those requested already
+   */
+  bool HasBufferSpaceForPrefetch();
+
+  static double GetSegmentDuration(const dash::mpd::IRepresentation* representation);
+
   TracedCallback<Ptr<ns3::Application> /*App*/, unsigned int /* UserId */, unsigned int /*SegmentNr*/,
                 std::string /*RepresentationId*/, unsigned int /* experiendedBitrate */,
                 unsigned int /*StallingTime*/, unsigned int /* buffer level */,
@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Incremental HTTP/1.1 request parser used by the HTTP servers
+
+#include "http-request-parser.h"
+
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+
+namespace ns3
+{
+
+bool
+HttpHeaderNameEquals(const char* field, size_t fieldLength, const char* name)
+{
+  return fieldLength == strlen(name) && strncasecmp(field, name, fieldLength) == 0;
+}
+
+
+bool
+HttpHeaderHasToken(const char* value, size_t length, const char* token)
+{
+  size_t tokenLength = strlen(token);
+  size_t i = 0;
+  while (i < length)
+  {
+    while (i < length && (value[i] == ' ' || value[i] == '\t' || value[i] == ','))
+      i++;
+    size_t start = i;
+    while (i < length && value[i] != ',')
+      i++;
+    size_t end = i;
+    while (end > start && (value[end-1] == ' ' || value[end-1] == '\t'))
+      end--;
+    if (end - start == tokenLength && strncasecmp(value + start, token, tokenLength) == 0)
+      return true;
+  }
+  return false;
+}
+
+
+bool
+HttpHeaderParseLength(const char* value, size_t length, uint64_t& result)
+{
+  result = 0;
+  size_t i = 0;
+  for (; i < length && isdigit(value[i]); i++)
+  {
+    if (result > (UINT64_MAX - 9) / 10)
+      return false;
+    result = result * 10 + (value[i] - '0');
+  }
+  return i > 0;
+}
+
+
+static bool
+IsDecimal(const char* value, size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+  {
+    if (!isdigit(value[i]))
+      return false;
+  }
+  return true;
+}
+
+
+HttpRequestParser::HttpRequestParser(size_t maxHeaderSize, size_t maxPendingRequests)
+  : m_maxHeaderSize(maxHeaderSize), m_maxPendingRequests(maxPendingRequests)
+{
+  Reset();
+}
+
+
+void
+HttpRequestParser::Reset()
+{
+  m_state = REQUEST_LINE;
+  m_line.clear();
+  m_headerSize = 0;
+  m_bodyRemaining = 0;
+  m_requests.clear();
+}
+
+
+bool
+HttpRequestParser::Parse(const uint8_t* data, size_t size)
+{
+  size_t pos = 0;
+  while (pos < size && m_state != PARSE_ERROR)
+  {
+    if (m_state == BODY)
+    {
+      // request bodies are not used by the servers, skip them
+      uint64_t skip = size - pos;
+      if (skip > m_bodyRemaining)
+        skip = m_bodyRemaining;
+      pos += skip;
+      m_bodyRemaining -= skip;
+      if (m_bodyRemaining == 0 && !CompleteRequest())
+        m_state = PARSE_ERROR;
+      continue;
+    }
+
+    const char* chunk = (const char*) data + pos;
+    const char* eol = (const char*) memchr(chunk, '\n', size - pos);
+    size_t length = eol != NULL ? (size_t)(eol - chunk) : size - pos;
+
+    m_headerSize += length + (eol != NULL ? 1 : 0);
+    if (m_headerSize > m_maxHeaderSize)
+    {
+      m_state = PARSE_ERROR;
+      break;
+    }
+
+    if (eol == NULL)
+    {
+      // keep the beginning of the line until the rest arrives
+      m_line.append(chunk, length);
+      break;
+    }
+    pos += length + 1;
+
+    const char* line = chunk;
+    if (!m_line.empty())
+    {
+      m_line.append(chunk, length);
+      line = m_line.data();
+      length = m_line.size();
+    }
+    if (length > 0 && line[length-1] == '\r')
+      length--;
+
+    bool ok = ParseLine(line, length);
+    m_line.clear();
+    if (!ok)
+      m_state = PARSE_ERROR;
+  }
+
+  return m_state != PARSE_ERROR;
+}
+
+
+bool
+HttpRequestParser::ParseLine(const char* line, size_t length)
+{
+  if (m_state == REQUEST_LINE)
+  {
+    if (length == 0)
+    {
+      // empty lines before a request line are ignored
+      m_headerSize = 0;
+      return true;
+    }
+    return ParseRequestLine(line, length);
+  }
+
+  if (length == 0)
+  {
+    // end of the header
+    if (m_bodyRemaining > 0)
+    {
+      m_state = BODY;
+      return true;
+    }
+    return CompleteRequest();
+  }
+  return ParseHeaderLine(line, length);
+}
+
+
+bool
+HttpRequestParser::ParseRequestLine(const char* line, size_t length)
+{
+  // METHOD SP request-target SP HTTP/1.x
+  const char* end = line + length;
+  const char* sp1 = (const char*) memchr(line, ' ', length);
+  if (sp1 == NULL || sp1 == line)
+    return false;
+  const char* target = sp1 + 1;
+  const char* sp2 = (const char*) memchr(target, ' ', end - target);
+  if (sp2 == NULL || sp2 == target)
+    return false;
+  const char* version = sp2 + 1;
+  if (end - version != 8 || strncmp(version, "HTTP/1.", 7) != 0 || !isdigit(version[7]))
+    return false;
+
+  m_current.method.assign(line, sp1 - line);
+  m_current.uri.assign(target, sp2 - target);
+  // the clients of this module only keep a connection alive when they ask for it
+  m_current.keepAlive = false;
+  m_current.hasRange = false;
+  m_current.rangeIsSuffix = false;
+  m_current.rangeFirst = 0;
+  m_current.rangeLast = 0;
+  m_bodyRemaining = 0;
+  m_state = HEADER_LINE;
+  return true;
+}
+
+
+bool
+HttpRequestParser::ParseHeaderLine(const char* line, size_t length)
+{
+  const char* colon = (const char*) memchr(line, ':', length);
+  if (colon == NULL || colon == line)
+    return false;
+
+  size_t nameLength = colon - line;
+  const char* value = colon + 1;
+  size_t valueLength = length - nameLength - 1;
+  while (valueLength > 0 && (*value == ' ' || *value == '\t'))
+  {
+    value++;
+    valueLength--;
+  }
+
+  if (HttpHeaderNameEquals(line, nameLength, "Connection"))
+  {
+    if (HttpHeaderHasToken(value, valueLength, "keep-alive"))
+      m_current.keepAlive = true;
+    if (HttpHeaderHasToken(value, valueLength, "close"))
+      m_current.keepAlive = false;
+  }
+  else if (HttpHeaderNameEquals(line, nameLength, "Content-Length"))
+  {
+    if (!HttpHeaderParseLength(value, valueLength, m_bodyRemaining))
+      return false;
+  }
+  else if (HttpHeaderNameEquals(line, nameLength, "Transfer-Encoding"))
+  {
+    // chunked request bodies are not supported
+    return false;
+  }
+  else if (HttpHeaderNameEquals(line, nameLength, "Range"))
+  {
+    ParseRange(value, valueLength);
+  }
+  return true;
+}
+
+
+void
+HttpRequestParser::ParseRange(const char* value, size_t length)
+{
+  // a single range of bytes: bytes=first-last, bytes=first- or bytes=-suffixLength; anything else,
+  // including multiple ranges, is ignored, i.e., the whole file is sent
+  m_current.hasRange = false;
+  if (length < 7 || strncasecmp(value, "bytes=", 6) != 0 || memchr(value, ',', length) != NULL)
+    return;
+
+  const char* spec = value + 6;
+  size_t specLength = length - 6;
+  while (specLength > 0 && (spec[specLength-1] == ' ' || spec[specLength-1] == '\t'))
+    specLength--;
+
+  const char* dash = (const char*) memchr(spec, '-', specLength);
+  if (dash == NULL)
+    return;
+  size_t firstLength = dash - spec;
+  size_t lastLength = specLength - firstLength - 1;
+
+  uint64_t first = 0, last = UINT64_MAX;
+  if (firstLength > 0 && (!IsDecimal(spec, firstLength) || !HttpHeaderParseLength(spec, firstLength, first)))
+    return;
+  if (lastLength > 0 && (!IsDecimal(dash + 1, lastLength) || !HttpHeaderParseLength(dash + 1, lastLength, last)))
+    return;
+
+  if (firstLength == 0)
+  {
+    if (lastLength == 0)
+      return;
+    m_current.rangeIsSuffix = true;
+  } else
+  {
+    if (last < first)
+      return;
+    m_current.rangeIsSuffix = false;
+  }
+
+  m_current.hasRange = true;
+  m_current.rangeFirst = first;
+  m_current.rangeLast = last;
+}
+
+
+bool
+HttpRequestParser::Request::GetByteRange(uint64_t size, uint64_t& first, uint64_t& length) const
+{
+  first = 0;
+  length = size;
+  if (!hasRange)
+    return true;
+
+  if (rangeIsSuffix)
+  {
+    // the last rangeLast bytes
+    if (rangeLast == 0)
+      return false;
+    length = rangeLast < size ? rangeLast : size;
+    first = size - length;
+    return true;
+  }
+
+  if (rangeFirst >= size)
+    return false;
+
+  first = rangeFirst;
+  uint64_t last = rangeLast < size ? rangeLast : size - 1;
+  length = last - first + 1;
+  return true;
+}
+
+
+bool
+HttpRequestParser::CompleteRequest()
+{
+  if (m_requests.size() >= m_maxPendingRequests)
+    return false;
+
+  m_requests.push_back(m_current);
+  m_headerSize = 0;
+  m_state = REQUEST_LINE;
+  return true;
+}
+
+
+bool
+HttpRequestParser::HasRequest() const
+{
+  return !m_requests.empty();
+}
+
+
+const HttpRequestParser::Request&
+HttpRequestParser::GetRequest() const
+{
+  return m_requests.front();
+}
+
+
+void
+HttpRequestParser::PopRequest()
+{
+  m_requests.pop_front();
+}
+
+
+bool
+HttpRequestParser::HasError() const
+{
+  return m_state == PARSE_ERROR;
+}
+
+} // namespace ns3
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Incremental HTTP/1.1 request parser used by the HTTP servers
+
+
+#ifndef HTTP_REQUEST_PARSER_H
+#define HTTP_REQUEST_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <deque>
+
+
+namespace ns3
+{
+
+/**
+ * \return whether the header field name (of the given length) is name, ignoring case
+ */
+bool HttpHeaderNameEquals(const char* field, size_t fieldLength, const char* name);
+
+/**
+ * \return whether the comma separated header value (of the given length) contains token, ignoring case
+ */
+bool HttpHeaderHasToken(const char* value, size_t length, const char* token);
+
+/**
+ * \brief Parse a decimal length, e.g., the value of a Content-Length header
+ * \return false if value does not start with a digit or the length overflows
+ */
+bool HttpHeaderParseLength(const char* value, size_t length, uint64_t& result);
+
+
+/**
+ * \brief Incremental HTTP/1.1 request parser
+ *
+ * Bytes are fed as they arrive from the socket, in chunks of any size, and complete requests are queued
+ * in the order they were received, so requests split over several packets and pipelined requests in one
+ * packet are handled alike. Lines which are completely contained in a chunk are parsed in place, only a
+ * line split over chunks is copied. The size of the header of a request and the number of queued requests
+ * are bounded; exceeding them, or a malformed request, puts the parser into an error state.
+ */
+class HttpRequestParser
+{
+public:
+  /**
+   * \brief A parsed request
+   */
+  struct Request
+  {
+    std::string method;   ///< \brief e.g., GET
+    std::string uri;      ///< \brief the request target, e.g., /content/vid1.mpd.gz
+    bool keepAlive;       ///< \brief whether the client asked to keep the connection alive (Connection: keep-alive)
+    bool hasRange;        ///< \brief whether the client asked for a single byte range (Range: bytes=first-last)
+    bool rangeIsSuffix;   ///< \brief whether the range is the last rangeLast bytes (Range: bytes=-rangeLast)
+    uint64_t rangeFirst;  ///< \brief the first byte of the range
+    uint64_t rangeLast;   ///< \brief the last byte of the range, UINT64_MAX if it is open ended
+
+    /**
+     * \brief Resolve the requested byte range against the size of the requested file
+     * \param first the first byte to send
+     * \param length the number of bytes to send
+     * \return false if the range can not be satisfied, i.e., it starts after the end of the file
+     */
+    bool GetByteRange(uint64_t size, uint64_t& first, uint64_t& length) const;
+  };
+
+  /**
+   * \param maxHeaderSize the maximum size of the request line and headers of a request in bytes
+   * \param maxPendingRequests the maximum number of parsed requests that have not been popped yet
+   */
+  HttpRequestParser(size_t maxHeaderSize = 8192, size_t maxPendingRequests = 64);
+
+  /**
+   * \brief Parse the next chunk of received bytes
+   * \return false if the parser is in the error state
+   */
+  bool Parse(const uint8_t* data, size_t size);
+
+  bool HasRequest() const;
+
+  /**
+   * \return the oldest request that has not been popped yet
+   */
+  const Request& GetRequest() const;
+
+  void PopRequest();
+
+  bool HasError() const;
+
+  /**
+   * \brief Drop all state, e.g., when the connection is reused
+   */
+  void Reset();
+
+protected:
+  enum State
+  {
+    REQUEST_LINE,
+    HEADER_LINE,
+    BODY,
+    PARSE_ERROR
+  };
+
+  bool ParseLine(const char* line, size_t length);
+  bool ParseRequestLine(const char* line, size_t length);
+  bool ParseHeaderLine(const char* line, size_t length);
+  void ParseRange(const char* value, size_t length);
+  bool CompleteRequest();
+
+  size_t m_maxHeaderSize;
+  size_t m_maxPendingRequests;
+
+  State m_state;
+  std::string m_line;         ///< \brief the beginning of a line split over chunks
+  size_t m_headerSize;        ///< \brief bytes of the current request header parsed so far
+  uint64_t m_bodyRemaining;   ///< \brief bytes of the current request body still to skip
+
+  Request m_current;
+  std::deque<Request> m_requests;
+};
+
+} // namespace ns3
+
+
+#endif /* HTTP_REQUEST_PARSER_H */
@@ -0,0 +1,360 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Incremental HTTP/1.1 response parser used by the HTTP client
+
+#include "http-response-parser.h"
+#include "http-request-parser.h"
+
+#include <string.h>
+#include <ctype.h>
+
+
+namespace ns3
+{
+
+HttpResponseParser::HttpResponseParser(size_t maxHeaderSize)
+  : m_maxHeaderSize(maxHeaderSize)
+{
+  Reset();
+}
+
+
+void
+HttpResponseParser::Reset()
+{
+  m_line.clear();
+  m_keepAlive = true;
+  NextResponse();
+}
+
+
+void
+HttpResponseParser::NextResponse()
+{
+  m_state = STATUS_LINE;
+  m_line.clear();
+  m_headerSize = 0;
+  m_bodyRemaining = 0;
+  m_statusCode = 0;
+  m_contentLength = -1;
+  m_chunked = false;
+  m_headerComplete = false;
+  m_bodyBytesReceived = 0;
+}
+
+
+size_t
+HttpResponseParser::Parse(const uint8_t* data, size_t size)
+{
+  size_t pos = 0;
+  while (pos < size)
+  {
+    if (m_state == BODY || m_state == CHUNK_DATA || m_state == COMPLETE || m_state == PARSE_ERROR)
+      break;
+
+    const char* chunk = (const char*) data + pos;
+    const char* eol = (const char*) memchr(chunk, '\n', size - pos);
+    size_t length = eol != NULL ? (size_t)(eol - chunk) : size - pos;
+
+    m_headerSize += length + (eol != NULL ? 1 : 0);
+    if (m_headerSize > m_maxHeaderSize)
+    {
+      m_state = PARSE_ERROR;
+      break;
+    }
+
+    if (eol == NULL)
+    {
+      // keep the beginning of the line until the rest arrives
+      m_line.append(chunk, length);
+      pos = size;
+      break;
+    }
+    pos += length + 1;
+
+    const char* line = chunk;
+    if (!m_line.empty())
+    {
+      m_line.append(chunk, length);
+      line = m_line.data();
+      length = m_line.size();
+    }
+    if (length > 0 && line[length-1] == '\r')
+      length--;
+
+    bool wasHeaderComplete = m_headerComplete;
+    bool ok = ParseLine(line, length);
+    m_line.clear();
+    if (!ok)
+    {
+      m_state = PARSE_ERROR;
+      break;
+    }
+
+    // give the caller the chance to handle the header before anything else
+    if (!wasHeaderComplete && m_headerComplete)
+      break;
+  }
+
+  return pos;
+}
+
+
+bool
+HttpResponseParser::ParseLine(const char* line, size_t length)
+{
+  switch (m_state)
+  {
+    case STATUS_LINE:
+      if (length == 0)
+      {
+        // empty lines before a status line are ignored
+        m_headerSize = 0;
+        return true;
+      }
+      return ParseStatusLine(line, length);
+    case HEADER_LINE:
+      if (length == 0)
+        return CompleteHeader();
+      return ParseHeaderLine(line, length);
+    case CHUNK_SIZE:
+      m_headerSize = 0;
+      return ParseChunkSize(line, length);
+    case CHUNK_DATA_END:
+      // every chunk is followed by CRLF
+      m_headerSize = 0;
+      m_state = CHUNK_SIZE;
+      return length == 0;
+    case TRAILER:
+      // trailer fields are ignored
+      if (length == 0)
+        m_state = COMPLETE;
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+bool
+HttpResponseParser::ParseStatusLine(const char* line, size_t length)
+{
+  // HTTP/1.x SP status-code SP reason-phrase
+  if (length < 12 || strncmp(line, "HTTP/1.", 7) != 0 || !isdigit(line[7]) || line[8] != ' '
+      || !isdigit(line[9]) || !isdigit(line[10]) || !isdigit(line[11]) || (length > 12 && line[12] != ' '))
+    return false;
+
+  m_statusCode = (line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0');
+  // HTTP/1.1 connections are persistent unless the server says otherwise, HTTP/1.0 connections are not
+  m_keepAlive = line[7] != '0';
+  m_state = HEADER_LINE;
+  return true;
+}
+
+
+bool
+HttpResponseParser::ParseHeaderLine(const char* line, size_t length)
+{
+  const char* colon = (const char*) memchr(line, ':', length);
+  if (colon == NULL || colon == line)
+    return false;
+
+  size_t nameLength = colon - line;
+  const char* value = colon + 1;
+  size_t valueLength = length - nameLength - 1;
+  while (valueLength > 0 && (*value == ' ' || *value == '\t'))
+  {
+    value++;
+    valueLength--;
+  }
+
+  if (HttpHeaderNameEquals(line, nameLength, "Content-Length"))
+  {
+    uint64_t contentLength;
+    if (!HttpHeaderParseLength(value, valueLength, contentLength) || contentLength > INT64_MAX)
+      return false;
+    m_contentLength = contentLength;
+  }
+  else if (HttpHeaderNameEquals(line, nameLength, "Transfer-Encoding"))
+  {
+    m_chunked = HttpHeaderHasToken(value, valueLength, "chunked");
+  }
+  else if (HttpHeaderNameEquals(line, nameLength, "Connection"))
+  {
+    if (HttpHeaderHasToken(value, valueLength, "close"))
+      m_keepAlive = false;
+    else if (HttpHeaderHasToken(value, valueLength, "keep-alive"))
+      m_keepAlive = true;
+  }
+  return true;
+}
+
+
+bool
+HttpResponseParser::CompleteHeader()
+{
+  m_headerComplete = true;
+  m_headerSize = 0;
+
+  if ((m_statusCode >= 100 && m_statusCode < 200) || m_statusCode == 204 || m_statusCode == 304)
+  {
+    // responses without a body
+    m_state = COMPLETE;
+  }
+  else if (m_chunked)
+  {
+    // chunked transfer encoding overrides Content-Length
+    m_state = CHUNK_SIZE;
+  }
+  else if (m_contentLength >= 0)
+  {
+    m_bodyRemaining = m_contentLength;
+    m_state = m_bodyRemaining > 0 ? BODY : COMPLETE;
+  }
+  else
+  {
+    // the body is delimited by closing the connection
+    m_bodyRemaining = UINT64_MAX;
+    m_keepAlive = false;
+    m_state = BODY;
+  }
+  return true;
+}
+
+
+bool
+HttpResponseParser::ParseChunkSize(const char* line, size_t length)
+{
+  // chunk-size in hex, optionally followed by ;chunk-extensions
+  uint64_t chunkSize = 0;
+  size_t i = 0;
+  for (; i < length && isxdigit(line[i]); i++)
+  {
+    if (chunkSize > (UINT64_MAX >> 4))
+      return false;
+    chunkSize = (chunkSize << 4) + (isdigit(line[i]) ? line[i] - '0' : (tolower(line[i]) - 'a' + 10));
+  }
+  if (i == 0)
+    return false;
+
+  if (chunkSize == 0)
+  {
+    m_state = TRAILER;
+  }
+  else
+  {
+    m_bodyRemaining = chunkSize;
+    m_state = CHUNK_DATA;
+  }
+  return true;
+}
+
+
+uint64_t
+HttpResponseParser::GetBodyBytesPending() const
+{
+  if (m_state == BODY || m_state == CHUNK_DATA)
+    return m_bodyRemaining;
+  return 0;
+}
+
+
+void
+HttpResponseParser::ConsumeBody(uint64_t size)
+{
+  if (size > GetBodyBytesPending())
+  {
+    m_state = PARSE_ERROR;
+    return;
+  }
+
+  m_bodyBytesReceived += size;
+  if (m_bodyRemaining == UINT64_MAX)
+    return; // until the connection is closed
+
+  m_bodyRemaining -= size;
+  if (m_bodyRemaining == 0)
+    m_state = m_state == CHUNK_DATA ? CHUNK_DATA_END : COMPLETE;
+}
+
+
+void
+HttpResponseParser::ConnectionClosed()
+{
+  if (m_state == BODY && m_bodyRemaining == UINT64_MAX)
+    m_state = COMPLETE;
+}
+
+
+bool
+HttpResponseParser::IsHeaderComplete() const
+{
+  return m_headerComplete;
+}
+
+
+bool
+HttpResponseParser::IsResponseComplete() const
+{
+  return m_state == COMPLETE;
+}
+
+
+bool
+HttpResponseParser::HasError() const
+{
+  return m_state == PARSE_ERROR;
+}
+
+
+int
+HttpResponseParser::GetStatusCode() const
+{
+  return m_statusCode;
+}
+
+
+int64_t
+HttpResponseParser::GetContentLength() const
+{
+  return m_contentLength;
+}
+
+
+bool
+HttpResponseParser::IsChunked() const
+{
+  return m_chunked;
+}
+
+
+bool
+HttpResponseParser::IsKeepAlive() const
+{
+  return m_keepAlive;
+}
+
+
+uint64_t
+HttpResponseParser::GetBodyBytesReceived() const
+{
+  return m_bodyBytesReceived;
+}
+
+} // namespace ns3
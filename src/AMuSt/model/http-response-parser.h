@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Incremental HTTP/1.1 response parser used by the HTTP client
+
+
+#ifndef HTTP_RESPONSE_PARSER_H
+#define HTTP_RESPONSE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+
+namespace ns3
+{
+
+/**
+ * \brief Incremental HTTP/1.1 response parser
+ *
+ * Only the status line, the headers and the chunk framing of chunked transfer encoding are parsed; they
+ * are fed with Parse. Body bytes are never inspected: GetBodyBytesPending tells how many of the following
+ * bytes belong to the body, and the caller skips them with ConsumeBody, so they do not have to be copied
+ * out of the received packets at all. Parse stops at the end of the header and at the end of a response,
+ * so responses pipelined on one connection are handled one after the other (see NextResponse).
+ */
+class HttpResponseParser
+{
+public:
+  /**
+   * \param maxHeaderSize the maximum size of the status line and headers of a response in bytes
+   */
+  HttpResponseParser(size_t maxHeaderSize = 16384);
+
+  /**
+   * \brief Parse header or chunk framing bytes
+   * \return the number of bytes consumed, which is less than size if the header or the response was
+   * completed, or if body bytes follow
+   */
+  size_t Parse(const uint8_t* data, size_t size);
+
+  /**
+   * \return the number of body bytes that follow and have to be passed to ConsumeBody instead of Parse,
+   * UINT64_MAX if the body is delimited by closing the connection
+   */
+  uint64_t GetBodyBytesPending() const;
+
+  /**
+   * \brief Skip size body bytes, size must not exceed GetBodyBytesPending
+   */
+  void ConsumeBody(uint64_t size);
+
+  /**
+   * \brief Complete a response whose body is delimited by closing the connection
+   */
+  void ConnectionClosed();
+
+  bool IsHeaderComplete() const;
+  bool IsResponseComplete() const;
+  bool HasError() const;
+
+  /**
+   * \brief Start parsing the next response on the same connection, once the current one is complete
+   */
+  void NextResponse();
+
+  /**
+   * \brief Drop all state, e.g., when a new connection is opened
+   */
+  void Reset();
+
+  int GetStatusCode() const;
+
+  /**
+   * \return the value of the Content-Length header, -1 if there was none
+   */
+  int64_t GetContentLength() const;
+
+  bool IsChunked() const;
+
+  /**
+   * \return whether the server keeps the connection open after this response
+   */
+  bool IsKeepAlive() const;
+
+  /**
+   * \return the number of body bytes of the current response consumed so far
+   */
+  uint64_t GetBodyBytesReceived() const;
+
+protected:
+  enum State
+  {
+    STATUS_LINE,
+    HEADER_LINE,
+    BODY,
+    CHUNK_SIZE,
+    CHUNK_DATA,
+    CHUNK_DATA_END,
+    TRAILER,
+    COMPLETE,
+    PARSE_ERROR
+  };
+
+  bool ParseLine(const char* line, size_t length);
+  bool ParseStatusLine(const char* line, size_t length);
+  bool ParseHeaderLine(const char* line, size_t length);
+  bool ParseChunkSize(const char* line, size_t length);
+  bool CompleteHeader();
+
+  size_t m_maxHeaderSize;
+
+  State m_state;
+  std::string m_line;         ///< \brief the beginning of a line split over chunks
+  size_t m_headerSize;        ///< \brief bytes of the current header (or chunk framing line) parsed so far
+  uint64_t m_bodyRemaining;   ///< \brief bytes of the body (or current chunk) still to consume
+
+  int m_statusCode;
+  int64_t m_contentLength;
+  bool m_chunked;
+  bool m_keepAlive;
+  bool m_headerComplete;
+  uint64_t m_bodyBytesReceived;
+};
+
+} // namespace ns3
+
+
+#endif /* HTTP_RESPONSE_PARSER_H */
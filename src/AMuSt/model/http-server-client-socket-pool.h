@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Pool of the client socket handlers of the HTTP servers
+
+
+#ifndef HTTP_SERVER_CLIENT_SOCKET_POOL_H
+#define HTTP_SERVER_CLIENT_SOCKET_POOL_H
+
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+
+#include "http-server-file-catalog.h"
+#include "http-server-file-cache.h"
+#include "http-server-fake-clientsocket.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+
+namespace ns3
+{
+
+/**
+ * \brief Free list of the client socket handlers (HttpServerFakeClientSocket or a subclass) of a HTTP server
+ *
+ * Handlers of closed connections are not deleted but reset and reused for new connections, so their receive
+ * and transmit buffers are reused as well. A handler is released from within its own socket callbacks, so it
+ * is only put back to the free list after the current event (in the same simulation tick). Up to maxIdle
+ * handlers are kept in the free list, further ones are deleted. The pool owns all handlers it created.
+ */
+template<class T>
+class HttpServerClientSocketPool
+{
+public:
+  /**
+   * \param catalog, fileCache, finishedCallback passed to every handler that is created
+   * \param maxIdle the maximum number of handlers kept for reuse
+   */
+  HttpServerClientSocketPool(HttpServerFileCatalog& catalog, HttpServerFileCache& fileCache,
+                             Callback<void, uint64_t> finishedCallback, uint32_t maxIdle = 256)
+    : m_catalog(catalog), m_fileCache(fileCache), m_finishedCallback(finishedCallback),
+      m_maxIdle(maxIdle), m_active(0), m_allocated(0), m_reused(0)
+  {
+    m_replyStatistics.replies = 0;
+    m_replyStatistics.sendCalls = 0;
+  }
+
+  ~HttpServerClientSocketPool()
+  {
+    m_reclaimEvent.Cancel();
+    for (typename std::vector<T*>::iterator it = m_handlers.begin(); it != m_handlers.end(); ++it)
+    {
+      delete *it;
+    }
+  }
+
+  /**
+   * \brief Set the content directory passed to handlers that are created from now on
+   */
+  void SetContentDirectory(const std::string& contentDir)
+  {
+    m_contentDir = contentDir;
+  }
+
+  /**
+   * \brief Get a handler for a new connection, reusing an idle one if possible
+   */
+  T* Allocate(uint64_t socket_id)
+  {
+    T* handler;
+    if (!m_idle.empty())
+    {
+      handler = m_idle.back();
+      m_idle.pop_back();
+      handler->Reset(socket_id);
+      m_reused++;
+    } else
+    {
+      handler = new T(socket_id, m_contentDir, m_catalog, m_fileCache, m_finishedCallback);
+      m_handlers.push_back(handler);
+      m_allocated++;
+    }
+    handler->SetReplyStatistics(&m_replyStatistics);
+    m_active++;
+    return handler;
+  }
+
+  /**
+   * \brief Give a handler back after its connection was closed; it is reclaimed after the current event
+   */
+  void Release(T* handler)
+  {
+    m_released.push_back(handler);
+    m_active--;
+    if (!m_reclaimEvent.IsRunning())
+    {
+      m_reclaimEvent = Simulator::ScheduleNow(&HttpServerClientSocketPool<T>::Reclaim, this);
+    }
+  }
+
+  /**
+   * \return the number of handlers in use
+   */
+  uint32_t GetActive() const
+  {
+    return m_active;
+  }
+
+  /**
+   * \return the number of handlers waiting for reuse, including those released in this event
+   */
+  uint32_t GetIdle() const
+  {
+    return m_idle.size() + m_released.size();
+  }
+
+  /**
+   * \return the number of handlers that were created
+   */
+  uint64_t GetAllocated() const
+  {
+    return m_allocated;
+  }
+
+  /**
+   * \return the number of connections that were given a reused handler
+   */
+  uint64_t GetReused() const
+  {
+    return m_reused;
+  }
+
+  /**
+   * \return the number of replies sent by all handlers and their Send calls
+   */
+  const HttpServerReplyStatistics& GetReplyStatistics() const
+  {
+    return m_replyStatistics;
+  }
+
+protected:
+  void Reclaim()
+  {
+    for (typename std::vector<T*>::iterator it = m_released.begin(); it != m_released.end(); ++it)
+    {
+      T* handler = *it;
+      if (m_idle.size() < m_maxIdle)
+      {
+        // drop the state of the connection (e.g., a mapped file) now, but keep the buffers
+        handler->Reset(0);
+        m_idle.push_back(handler);
+      } else
+      {
+        m_handlers.erase(std::find(m_handlers.begin(), m_handlers.end(), handler));
+        delete handler;
+      }
+    }
+    m_released.clear();
+  }
+
+  std::string m_contentDir;
+  HttpServerFileCatalog& m_catalog;
+  HttpServerFileCache& m_fileCache;
+  Callback<void, uint64_t> m_finishedCallback;
+
+  uint32_t m_maxIdle;
+
+  std::vector<T*> m_handlers; ///< \brief all handlers created by the pool
+  std::vector<T*> m_idle;     ///< \brief handlers that can be reused
+  std::vector<T*> m_released; ///< \brief handlers released during the current event
+  EventId m_reclaimEvent;
+
+  uint32_t m_active;
+  uint64_t m_allocated;
+  uint64_t m_reused;
+
+  HttpServerReplyStatistics m_replyStatistics;
+};
+
+} // namespace ns3
+
+
+#endif /* HTTP_SERVER_CLIENT_SOCKET_POOL_H */
@@ -2,6 +2,7 @@
 
 
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 
 #include "ns3/socket.h"
@@ -20,9 +21,9 @@ namespace ns3
 
 HttpServerFakeClientSocket::HttpServerFakeClientSocket(uint64_t socket_id,
     std::string contentDir,
-    std::map<std::string /* filename */, long /* file size */>& fileSizes,
-    std::vector<std::string /* filename */>& virtualFiles,
-    Callback<void, uint64_t> finished_callback) : m_fileSizes(fileSizes), m_virtualFiles(virtualFiles)
+    HttpServerFileCatalog& catalog,
+    HttpServerFileCache& fileCache,
+    Callback<void, uint64_t> finished_callback) : m_catalog(catalog), m_fileCache(fileCache)
 {
   this->m_socket_id = socket_id;
   this->m_finished_callback = finished_callback;
@@ -30,13 +31,18 @@ HttpServerFakeClientSocket::HttpServerFakeClientSocket(uint64_t socket_id,
   bytes_sent = 0;
   m_currentBytesTx = 0;
   m_totalBytesToTx = 0;
-  m_activeRecvString = "";
   m_is_shutdown = false;
   m_content_dir = contentDir;
 
   m_keep_alive = false;
 
   m_is_virtual_file = false;
+
+  m_body = NULL;
+
+  m_sendCalls = 0;
+
+  m_replyStatistics = NULL;
 }
 
 
@@ -48,85 +54,106 @@ HttpServerFakeClientSocket::~HttpServerFakeClientSocket()
 }
 
 
+void
+HttpServerFakeClientSocket::Reset(uint64_t socket_id)
+{
+  m_socket_id = socket_id;
+  bytes_recv = 0;
+  bytes_sent = 0;
+  m_currentBytesTx = 0;
+  m_totalBytesToTx = 0;
+  m_sendCalls = 0;
+  m_is_shutdown = false;
+  m_keep_alive = false;
+  m_is_virtual_file = false;
 
+  m_bytesToTransmit.clear();
+  m_body = NULL;
+  m_mappedFile = 0;
 
+  m_requestParser.Reset();
+  m_from = Address();
+}
 
 
 void
-HttpServerFakeClientSocket::HandleIncomingData(Ptr<Socket> socket)
+HttpServerFakeClientSocket::SetReplyStatistics(HttpServerReplyStatistics* statistics)
 {
-  Ptr<Packet> packet;
-  Address from;
-  while ((packet = socket->RecvFrom (from)))
-  {
-    packet->RemoveAllPacketTags ();
-    packet->RemoveAllByteTags ();
+  m_replyStatistics = statistics;
+}
 
-    uint8_t* buffer = (uint8_t*) malloc ((size_t) packet->GetSize()+1);
-    // PARSE PACKET
-    size_t packet_size = packet->CopyData(buffer, packet->GetSize());
-    buffer[packet_size] = '\0';
 
-    // check if packet in m_activePackets
-    if (bytes_recv == 0)
-    {
-      m_activeRecvString = std::string((char*)buffer);
-      bytes_recv += packet_size;
-    } else
-    {
-      m_activeRecvString += std::string((char*)buffer);
-      bytes_recv += packet_size;
-    }
 
-    free(buffer);
 
 
-    if (string_ends_width(m_activeRecvString, std::string(CRLF)))
+
+void
+HttpServerFakeClientSocket::HandleIncomingData(Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+  {
+    uint32_t packet_size = packet->GetSize();
+    if (packet_size == 0)
+      continue;
+
+    // PARSE PACKET, requests may be split over several packets or pipelined in one packet
+    if (m_recvBuffer.size() < packet_size)
+      m_recvBuffer.resize(packet_size);
+    packet->CopyData(&m_recvBuffer[0], packet_size);
+    bytes_recv += packet_size;
+    m_from = from;
+
+    if (!m_requestParser.Parse(&m_recvBuffer[0], packet_size))
     {
-      m_currentBytesTx = 0;
-      m_totalBytesToTx = 0;
-      FinishedIncomingData(socket, from, m_activeRecvString);
+      fprintf(stderr, "Server(%ld): Malformed request received\n", m_socket_id);
+      break;
     }
   }
+
+  ServeNextRequest(socket);
 }
 
 
-std::string
-HttpServerFakeClientSocket::ParseHTTPHeader(std::string data)
+void
+HttpServerFakeClientSocket::ServeNextRequest(Ptr<Socket> socket)
 {
-  const char* cBuffer = data.c_str();
-
-  char needle1[5];
-  strcpy(needle1, "GET ");
-  needle1[4] = '\0';
-
-  char needle2[2];
-  needle2[0] = ' ';
-  needle2[1] = '\0';
-
-  // find the name that was requested
-  const char* p1 = strstr(cBuffer, needle1);
-  int pos1 = p1-cBuffer+4;
-  const char* p2 = strstr(& (cBuffer[pos1]), needle2);
-
-
-  int pos2 = p2 - &cBuffer[pos1];
-
-  char actualFileName[256];
+  if (m_is_shutdown || m_totalBytesToTx > 0) // still sending the previous reply
+    return;
 
-  strncpy(actualFileName, &cBuffer[pos1], pos2);
-  actualFileName[pos2] = '\0';
+  m_currentBytesTx = 0;
+  m_totalBytesToTx = 0;
 
-  std::string sFilename(actualFileName);
+  if (m_requestParser.HasRequest())
+  {
+    HttpRequestParser::Request request = m_requestParser.GetRequest();
+    m_requestParser.PopRequest();
+    m_keep_alive = request.keepAlive;
 
+    if (request.method != "GET")
+    {
+      fprintf(stderr, "Server(%ld): Method '%s' not implemented\n", m_socket_id, request.method.c_str());
+      ReplyWithStatus(socket, "501 Not Implemented");
+      return;
+    }
 
-  // check if keep-alive is set
-  if (data.find("Connection: keep-alive") != std::string::npos)
+    FinishedIncomingData(socket, m_from, request);
+  } else if (m_requestParser.HasError())
   {
-    this->m_keep_alive = true;
+    // all valid requests were answered, reply to the malformed one and close the connection
+    m_keep_alive = false;
+    ReplyWithStatus(socket, "400 Bad Request");
   }
+}
 
-  return sFilename;
+
+void
+HttpServerFakeClientSocket::ReplyWithStatus(Ptr<Socket> socket, const std::string& status)
+{
+  std::string replyString = "HTTP/1.1 " + status + CRLF + "Content-Length: 0" + CRLF + CRLF;
+  AddBytesToTransmit((const uint8_t*)replyString.c_str(), replyString.length());
+  HandleReadyToTransmit(socket, socket->GetTxAvailable());
 }
 
 
@@ -158,13 +185,13 @@ void HttpServerFakeClientSocket::ConnectionClosedError(Ptr<Socket> socket)
 }
 
 
-// GetFileSize either from m_fileSizes map or from disk
-long HttpServerFakeClientSocket::GetFileSize(std::string filename)
+// GetFileSize either from the catalog or from disk
+long HttpServerFakeClientSocket::GetFileSize(std::string filename, HttpServerFileCatalog::FileInfo& info)
 {
-  // check if is already in m_fileSizes
-  if (m_fileSizes.find(filename) != m_fileSizes.end())
+  // check if is already in the catalog
+  if (m_catalog.Find(filename, info))
   {
-    return m_fileSizes[filename];
+    return info.size;
   }
   // else: query disk for file size
 
@@ -173,7 +200,10 @@ long HttpServerFakeClientSocket::GetFileSize(std::string filename)
 
   if (rc == 0)
   {
-    m_fileSizes[filename] = stat_buf.st_size;
+    m_catalog.AddFile(filename, stat_buf.st_size);
+    info.size = stat_buf.st_size;
+    info.isVirtual = false;
+    info.contents = NULL;
     return stat_buf.st_size;
   }
   // else: file not found
@@ -197,92 +227,40 @@ HttpServerFakeClientSocket::LogStateChange(const ns3::TcpSocket::TcpStates_t old
 }
 
 void
-HttpServerFakeClientSocket::FinishedIncomingData(Ptr<Socket> socket, Address from, std::string data)
+HttpServerFakeClientSocket::FinishedIncomingData(Ptr<Socket> socket, Address from, const HttpRequestParser::Request& request)
 {
-  fprintf(stderr, "Server(%ld)::FinishedIncomingData(socket,data=str(%ld))\n", m_socket_id, data.length());
-  // now parse this request (TODO) and reply
-  std::string filename = m_content_dir  + ParseHTTPHeader(data);
+  fprintf(stderr, "Server(%ld)::FinishedIncomingData(socket,uri=%s)\n", m_socket_id, request.uri.c_str());
+  std::string filename = m_content_dir  + request.uri;
 
   fprintf(stderr, "Server(%ld): Opening '%s'\n", m_socket_id, filename.c_str());
 
-  long filesize = GetFileSize(filename);
+  HttpServerFileCatalog::FileInfo info;
+  long filesize = GetFileSize(filename, info);
 
   m_is_virtual_file = false;
+  uint64_t first, length;
 
   if (filesize == -1)
   {
     fprintf(stderr, "Server(%ld): Error, '%s' not found!\n", m_socket_id, filename.c_str());
     // return 404
-    std::string replyString("HTTP/1.1 404 Not Found\r\n\r\n");
+    std::string replyString("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
 
     AddBytesToTransmit((uint8_t*)replyString.c_str(), replyString.length());
-  } else
+  } else if (AddReplyHeader(request, filesize, first, length))
   {
-    // Create a proper header
-    std::stringstream replySS;
-    replySS << "HTTP/1.1 200 OK" << CRLF; // OR HTTP/1.1 404 Not Found
-    replySS << "Content-Type: text/xml; charset=utf-8" << CRLF; // e.g., when sending the MPD
-    replySS << "Content-Length: " << filesize << CRLF;
-    replySS << CRLF;
-
-    //fprintf(stderr, "Replying with header:\n%s\n", replySS.str().c_str());
-
-    std::string replyString = replySS.str();
-    uint8_t* buffer = (uint8_t*)replyString.c_str();
-    AddBytesToTransmit(buffer,replyString.length());
-
-    // now append the virtual payload data
-    uint8_t tmp[4096];
-
-
-    if (std::find(m_virtualFiles.begin(), m_virtualFiles.end(), filename) != m_virtualFiles.end())
+    if (info.isVirtual)
     {
-      // handle virtual payload
-      // fill tmp with some random data
-      fprintf(stderr, "Server(%ld): Generating virtual payload of size %ld ...\n", m_socket_id, filesize);
-
+      // handle virtual payload, it is sent as zero-filled virtual packets in HandleReadyToTransmit
+      fprintf(stderr, "Server(%ld): Generating virtual payload of size %ld ...\n", m_socket_id, (long) length);
 
-      this->m_totalBytesToTx += filesize;
+      this->m_totalBytesToTx += length;
       this->m_is_virtual_file = true;
-
-      /*
-      for (int i = 0; i < 4096; i++)
-      {
-        tmp[i] = (uint8_t)rand();
-      }
-
-
-      int cnt = 0;
-
-      while (cnt < filesize)
-      {
-        if (cnt + 4096 < filesize)
-        {
-          AddBytesToTransmit(tmp, 4096);
-        } else {
-          AddBytesToTransmit(tmp, filesize - cnt);
-        }
-        cnt += 4096;
-      } */
     } else
     {
       fprintf(stderr, "Server(%ld): Opening file on disk with size %ld ...\n", m_socket_id, filesize);
       // handle actual payload
-      FILE* fp = fopen(filename.c_str(), "rb");
-
-      int size_returned = 4096;
-
-      while (size_returned == 4096)
-      {
-        size_returned = fread(tmp, 1, 4096, fp);
-
-        if (size_returned > 0)
-        {
-          AddBytesToTransmit(tmp, size_returned);
-        }
-      }
-
-      fclose(fp);
+      AddFileBytesToTransmit(filename, first, length);
     }
   }
 
@@ -300,81 +278,39 @@ HttpServerFakeClientSocket::HandleReadyToTransmit(Ptr<Socket> socket, uint32_t t
     fprintf(stderr, "Server(%ld)::HandleReadyToTransmit: Nothing to transmit (yet)...\n", m_socket_id);
     return;
   }
-  if (m_currentBytesTx >= m_totalBytesToTx && m_totalBytesToTx > 0)
+  if (m_currentBytesTx >= m_totalBytesToTx)
   {
-    // already sent everything, check if we need to "close" the socket and disband this object, or if we keep it alive
-    if (!m_keep_alive)
-    {
-      if (!m_is_shutdown)
-      {
-        fprintf(stderr, "Server(%ld)::HandleReadyToTransmit: Sent %d bytes, now shutting down client socket (socket->close())\n", m_socket_id, m_currentBytesTx);
-
-        // Request this socket to close
-        socket->Close();
-        // remove the send callback
-        socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
-        // remove the recv callback
-        socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
-
-        // reset the header data from recvstring
-        m_activeRecvString = "";
-
-        // we already finished sending, so we can clear the buffer for the sake of saving memory
-        this->m_bytesToTransmit.clear();
-        std::vector<uint8_t>().swap( this->m_bytesToTransmit ); // explicitly clear the buffer
-        m_is_shutdown = true; // make sure to set that flag to true, so that we do not call this stuff again
-      }
-    } else {
-      // keeping connection alive
-
-      // reset the header data from recvstring
-      m_activeRecvString = "";
-
-      // we already finished sending, so we can clear the buffer for the sake of saving memory
-      this->m_bytesToTransmit.clear();
-      std::vector<uint8_t>().swap( this->m_bytesToTransmit ); // explicitly clear the buffer
-      m_is_shutdown = true;
-    }
+    FinishedTransmission(socket);
     return;
   }
   //fprintf(stderr, "Server(%ld)::HandleReadyToTransmit(socket,txSize=%u)\n", m_socket_id, txSize);
 
 
-  // get txSize bytes from m_bytesToTransmit, starting at byte m_currentBytesTx
+  // the header (and a body that is part of it) is sent from m_bytesToTransmit, the body from m_body or as virtual payload
+  uint32_t queuedBytes = (m_body != NULL || m_is_virtual_file) ? m_bytesToTransmit.size() : m_totalBytesToTx;
 
-
-  while (m_currentBytesTx < m_totalBytesToTx && socket->GetTxAvailable () > 0)
+  // every packet fills as much of the tx window as possible
+  uint32_t txAvailable;
+  while (m_currentBytesTx < m_totalBytesToTx && (txAvailable = socket->GetTxAvailable ()) > 0)
   {
-    uint32_t remainingBytes = m_totalBytesToTx - m_currentBytesTx;
-
-    if (remainingBytes > 2860)
-      remainingBytes = 2860;
-
-    remainingBytes = std::min(remainingBytes, socket->GetTxAvailable ());
+    uint32_t remainingBytes = std::min(m_totalBytesToTx - m_currentBytesTx, txAvailable);
 
     Ptr<Packet> replyPacket;
 
-    if (!m_is_virtual_file)
+    if (m_currentBytesTx < queuedBytes)
+    {
+      remainingBytes = std::min(remainingBytes, queuedBytes - m_currentBytesTx);
+      replyPacket = Create<Packet> (&((this->m_bytesToTransmit)[m_currentBytesTx]), remainingBytes);
+    } else if (m_is_virtual_file)
     {
-      uint8_t* buffer = (uint8_t*) &((this->m_bytesToTransmit)[m_currentBytesTx]);
-      replyPacket = Create<Packet> (buffer, remainingBytes);
+      // create a zero-filled virtual reply packet, without allocating its payload
+      replyPacket = Create<Packet> (remainingBytes);
     } else
     {
-      if (m_currentBytesTx == 0) // reply with header
-      {
-        uint8_t* buffer = (uint8_t*) &((this->m_bytesToTransmit)[m_currentBytesTx]);
-        replyPacket = Create<Packet> (buffer, this->m_bytesToTransmit.size());
-      } else {
-        // create a virtual reply packet
-        uint8_t* buffer = (uint8_t*)malloc(remainingBytes);
-
-        replyPacket = Create<Packet> (buffer, remainingBytes);
-        free(buffer);
-      }
+      replyPacket = Create<Packet> (m_body + (m_currentBytesTx - queuedBytes), remainingBytes);
     }
 
-
-
+    m_sendCalls++;
     int amountSent = socket->Send (replyPacket);
     if (amountSent <= 0)
     {
@@ -387,6 +323,137 @@ HttpServerFakeClientSocket::HandleReadyToTransmit(Ptr<Socket> socket, uint32_t t
 
     //fprintf(stderr, "Server(%ld)::HandleReadyToTransmit - Transmitted %d bytes, %u remaining\n", m_socket_id, amountSent, m_totalBytesToTx - m_currentBytesTx);
   }
+
+  if (m_currentBytesTx >= m_totalBytesToTx)
+  {
+    FinishedTransmission(socket);
+  }
+}
+
+
+void
+HttpServerFakeClientSocket::FinishedTransmission(Ptr<Socket> socket)
+{
+  if (m_replyStatistics != NULL)
+  {
+    m_replyStatistics->replies++;
+    m_replyStatistics->sendCalls += m_sendCalls;
+  }
+
+  m_sendCalls = 0;
+  m_currentBytesTx = 0;
+  m_totalBytesToTx = 0;
+  m_is_virtual_file = false;
+
+  // release the file the body was sent from, the cache decides whether it stays mapped
+  m_body = NULL;
+  m_mappedFile = 0;
+
+  // already sent everything, check if we need to "close" the socket and disband this object, or if we keep it alive
+  if (!m_keep_alive)
+  {
+    if (!m_is_shutdown)
+    {
+      fprintf(stderr, "Server(%ld)::FinishedTransmission: now shutting down client socket (socket->close())\n", m_socket_id);
+
+      // Request this socket to close
+      socket->Close();
+      // remove the send callback
+      socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+      // remove the recv callback
+      socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+
+      // we already finished sending; the buffer keeps its capacity, as this object is reused for another connection
+      this->m_bytesToTransmit.clear();
+      m_is_shutdown = true; // make sure to set that flag to true, so that we do not call this stuff again
+    }
+  } else {
+    // keeping connection alive, the buffer is reused for the next reply
+    this->m_bytesToTransmit.clear();
+
+    // serve the next pipelined request, if any
+    ServeNextRequest(socket);
+  }
+}
+
+
+bool
+HttpServerFakeClientSocket::AddReplyHeader(const HttpRequestParser::Request& request, uint64_t filesize, uint64_t& first, uint64_t& length)
+{
+  std::stringstream replySS;
+
+  if (!request.GetByteRange(filesize, first, length))
+  {
+    fprintf(stderr, "Server(%ld): Range of '%s' not satisfiable\n", m_socket_id, request.uri.c_str());
+    replySS << "HTTP/1.1 416 Range Not Satisfiable" << CRLF;
+    replySS << "Content-Range: bytes */" << filesize << CRLF;
+    replySS << "Content-Length: 0" << CRLF;
+    replySS << CRLF;
+
+    std::string replyString = replySS.str();
+    AddBytesToTransmit((const uint8_t*)replyString.c_str(), replyString.length());
+    return false;
+  }
+
+  // Create a proper header
+  if (request.hasRange)
+  {
+    replySS << "HTTP/1.1 206 Partial Content" << CRLF;
+    replySS << "Content-Range: bytes " << first << "-" << (first + length - 1) << "/" << filesize << CRLF;
+  } else
+  {
+    replySS << "HTTP/1.1 200 OK" << CRLF;
+  }
+  replySS << "Content-Type: text/xml; charset=utf-8" << CRLF; // e.g., when sending the MPD
+  replySS << "Accept-Ranges: bytes" << CRLF;
+  replySS << "Content-Length: " << length << CRLF;
+  replySS << CRLF;
+
+  //fprintf(stderr, "Replying with header:\n%s\n", replySS.str().c_str());
+
+  std::string replyString = replySS.str();
+  AddBytesToTransmit((const uint8_t*)replyString.c_str(), replyString.length());
+  return true;
+}
+
+
+void
+HttpServerFakeClientSocket::AddFileBytesToTransmit(const std::string& filename, uint64_t first, uint64_t length)
+{
+  // the file is mapped once and shared by all client sockets of the server
+  Ptr<const HttpServerFileCache::MappedFile> file = m_fileCache.Get(filename);
+  if (file != 0 && first + length <= file->GetSize())
+  {
+    m_mappedFile = file;
+    SetBodyToTransmit(file->GetData() + first, length);
+    return;
+  }
+
+  // the file could not be mapped (or has changed on disk), so it is copied
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (fp == NULL)
+  {
+    fprintf(stderr, "Server(%ld) ERROR: Could not open '%s'\n", m_socket_id, filename.c_str());
+    return;
+  }
+
+  if (first > 0)
+  {
+    fseek(fp, first, SEEK_SET);
+  }
+
+  uint8_t tmp[4096];
+  while (length > 0)
+  {
+    size_t size_returned = fread(tmp, 1, length < sizeof(tmp) ? length : sizeof(tmp), fp);
+    if (size_returned == 0)
+      break;
+
+    AddBytesToTransmit(tmp, size_returned);
+    length -= size_returned;
+  }
+
+  fclose(fp);
 }
 
 
@@ -396,4 +463,11 @@ void HttpServerFakeClientSocket::AddBytesToTransmit(const uint8_t* buffer, uint3
   this->m_totalBytesToTx += size;
 }
 
+
+void HttpServerFakeClientSocket::SetBodyToTransmit(const uint8_t* body, uint32_t size)
+{
+  this->m_body = body;
+  this->m_totalBytesToTx += size;
+}
+
 };
@@ -7,6 +7,11 @@
 #include "ns3/ptr.h"
 #include "ns3/string.h"
 #include "ns3/tcp-socket.h"
+#include "ns3/address.h"
+
+#include "http-server-file-catalog.h"
+#include "http-server-file-cache.h"
+#include "http-request-parser.h"
 
 #include <map>
 #include <vector>
@@ -19,16 +24,37 @@ class Socket;
 class Address;
 
 
+/**
+ * \brief Counters of the replies sent by the client socket handlers of a server
+ */
+struct HttpServerReplyStatistics
+{
+  uint64_t replies;   ///< \brief number of replies sent completely
+  uint64_t sendCalls; ///< \brief number of Socket::Send calls for these replies
+};
+
+
 class HttpServerFakeClientSocket
 {
 public:
   HttpServerFakeClientSocket(uint64_t socket_id,
-  std::string contentDir, std::map<std::string /* filename */, long /* file size */>& fileSizes,
-  std::vector<std::string /* filename */>& virtualFiles,
+  std::string contentDir, HttpServerFileCatalog& catalog, HttpServerFileCache& fileCache,
   Callback<void, uint64_t> finished_callback);
 
   virtual ~HttpServerFakeClientSocket();
 
+  /**
+   * \brief Drop the state of the previous connection, so this object can handle the connection socket_id
+   *
+   * The receive and transmit buffers keep their capacity.
+   */
+  void Reset(uint64_t socket_id);
+
+  /**
+   * \brief Count every reply sent completely and its Send calls in statistics, which must outlive this object
+   */
+  void SetReplyStatistics(HttpServerReplyStatistics* statistics);
+
 
   void HandleIncomingData(Ptr<Socket> socket);
 
@@ -46,12 +72,43 @@ public:
 protected:
   Callback<void, uint64_t> m_finished_callback;
 
-  virtual void FinishedIncomingData(Ptr<Socket> socket, Address from, std::string data);
+  virtual void FinishedIncomingData(Ptr<Socket> socket, Address from, const HttpRequestParser::Request& request);
   void AddBytesToTransmit(const uint8_t* buffer, uint32_t size);
 
-  std::string ParseHTTPHeader(std::string data);
+  /**
+   * \brief Start replying to the next request received on this connection, unless a reply is still being sent
+   */
+  void ServeNextRequest(Ptr<Socket> socket);
+
+  /**
+   * \brief Called when a reply was sent completely; closes the connection or serves the next pipelined request
+   */
+  void FinishedTransmission(Ptr<Socket> socket);
+
+  /**
+   * \brief Reply with an empty body and the given status, e.g., "400 Bad Request"
+   */
+  void ReplyWithStatus(Ptr<Socket> socket, const std::string& status);
 
-  long GetFileSize(std::string filename);
+  /**
+   * \brief Queue the header of the reply to request for a file of filesize bytes, honouring a single byte range
+   * \param first the first byte of the file to send
+   * \param length the number of bytes of the file to send
+   * \return false if the range can not be satisfied, a "416 Range Not Satisfiable" reply has been queued then
+   */
+  bool AddReplyHeader(const HttpRequestParser::Request& request, uint64_t filesize, uint64_t& first, uint64_t& length);
+
+  /**
+   * \brief Queue length bytes of a file on disk, starting at byte first; they are sent from the memory-mapped file
+   */
+  void AddFileBytesToTransmit(const std::string& filename, uint64_t first, uint64_t length);
+
+  /**
+   * \brief Send size bytes at body after the queued header, without copying them; body must stay valid until they are sent
+   */
+  void SetBodyToTransmit(const uint8_t* body, uint32_t size);
+
+  long GetFileSize(std::string filename, HttpServerFileCatalog::FileInfo& info);
 
 
 
@@ -65,6 +122,10 @@ protected:
   uint32_t m_totalBytesToTx;
   uint32_t m_currentBytesTx;
 
+  uint32_t m_sendCalls; ///< \brief number of Send calls for the reply that is being sent
+
+  HttpServerReplyStatistics* m_replyStatistics; ///< \brief counters of the server, NULL if not counted
+
   bool m_is_shutdown;
 
   bool m_is_virtual_file;
@@ -73,11 +134,18 @@ protected:
 
   std::vector<uint8_t> m_bytesToTransmit;
 
+  const uint8_t* m_body; ///< \brief body of the reply that is sent after m_bytesToTransmit, NULL if it is part of m_bytesToTransmit
+  Ptr<const HttpServerFileCache::MappedFile> m_mappedFile; ///< \brief keeps the file m_body points to mapped
+
+
+  HttpRequestParser m_requestParser;
+
+  std::vector<uint8_t> m_recvBuffer; ///< \brief reused for the payload of every received packet
 
-  std::string m_activeRecvString;
+  Address m_from;
 
-  std::map<std::string,long>& m_fileSizes;
-  std::vector<std::string>& m_virtualFiles;
+  HttpServerFileCatalog& m_catalog;
+  HttpServerFileCache& m_fileCache;
 };
 
 } // namespace ns3
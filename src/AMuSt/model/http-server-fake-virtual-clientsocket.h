@@ -13,16 +13,13 @@ class HttpServerFakeVirtualClientSocket : public HttpServerFakeClientSocket
 {
 public:
   HttpServerFakeVirtualClientSocket(uint64_t socket_id,
-  std::string contentDir, std::map<std::string /* filename */, long /* file size */>& fileSizes,
-  std::vector<std::string /* filename */>& fakeFiles, std::map<std::string,std::string>& /* virtual file host */ virtualHostedFiles,
+  std::string contentDir, HttpServerFileCatalog& catalog, HttpServerFileCache& fileCache,
   Callback<void, uint64_t> finished_callback);
 
   ~HttpServerFakeVirtualClientSocket();
 
 protected:
-  std::map<std::string,std::string>& m_virtualHostedFiles;
-
-  void FinishedIncomingData(Ptr<Socket> socket, Address from, std::string data);
+  void FinishedIncomingData(Ptr<Socket> socket, Address from, const HttpRequestParser::Request& request);
 
 
 };
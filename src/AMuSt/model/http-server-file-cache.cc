@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Cache of memory-mapped files served by the HTTP servers
+
+#include "http-server-file-cache.h"
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+namespace ns3
+{
+
+HttpServerFileCache::MappedFile::MappedFile(const uint8_t* data, uint64_t size)
+  : m_data(data), m_size(size)
+{
+}
+
+
+HttpServerFileCache::MappedFile::~MappedFile()
+{
+  if (m_data != NULL)
+  {
+    munmap((void*) m_data, m_size);
+  }
+}
+
+
+const uint8_t*
+HttpServerFileCache::MappedFile::GetData() const
+{
+  return m_data;
+}
+
+
+uint64_t
+HttpServerFileCache::MappedFile::GetSize() const
+{
+  return m_size;
+}
+
+
+HttpServerFileCache::HttpServerFileCache(uint64_t maxMappedBytes)
+  : m_maxMappedBytes(maxMappedBytes), m_mappedBytes(0), m_hits(0), m_misses(0), m_evictions(0)
+{
+}
+
+
+HttpServerFileCache::~HttpServerFileCache()
+{
+  Clear();
+}
+
+
+void
+HttpServerFileCache::SetMaxMappedBytes(uint64_t maxMappedBytes)
+{
+  m_maxMappedBytes = maxMappedBytes;
+  Evict();
+}
+
+
+Ptr<const HttpServerFileCache::MappedFile>
+HttpServerFileCache::Get(const std::string& path)
+{
+  std::unordered_map<std::string, LruList::iterator>::iterator it = m_files.find(path);
+  if (it != m_files.end())
+  {
+    m_hits++;
+    // move the file to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->second;
+  }
+
+  m_misses++;
+  Ptr<MappedFile> file = Map(path);
+  if (file == 0)
+  {
+    return 0;
+  }
+
+  // files that are larger than the cache are mapped for the request only
+  if (file->GetSize() > m_maxMappedBytes)
+  {
+    return file;
+  }
+
+  m_lru.push_front(std::make_pair(path, file));
+  m_files[path] = m_lru.begin();
+  m_mappedBytes += file->GetSize();
+  Evict();
+
+  return file;
+}
+
+
+void
+HttpServerFileCache::Clear()
+{
+  if (m_hits + m_misses > 0)
+  {
+    fprintf(stderr, "HttpServerFileCache: %lu files mapped, %lu times reused, %lu evicted\n",
+            (unsigned long) m_misses, (unsigned long) m_hits, (unsigned long) m_evictions);
+  }
+
+  m_lru.clear();
+  m_files.clear();
+  m_mappedBytes = 0;
+  m_hits = 0;
+  m_misses = 0;
+  m_evictions = 0;
+}
+
+
+Ptr<HttpServerFileCache::MappedFile>
+HttpServerFileCache::Map(const std::string& path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    fprintf(stderr, "HttpServerFileCache: Error, could not open '%s'\n", path.c_str());
+    return 0;
+  }
+
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0)
+  {
+    close(fd);
+    return 0;
+  }
+
+  uint64_t size = stat_buf.st_size;
+  void* data = NULL;
+
+  // an empty file can not be mapped, but there is nothing to send either
+  if (size > 0)
+  {
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+      fprintf(stderr, "HttpServerFileCache: Error, could not map '%s'\n", path.c_str());
+      close(fd);
+      return 0;
+    }
+  }
+
+  // the mapping stays valid after closing the file
+  close(fd);
+  return Create<MappedFile>((const uint8_t*) data, size);
+}
+
+
+void
+HttpServerFileCache::Evict()
+{
+  while (m_mappedBytes > m_maxMappedBytes && !m_lru.empty())
+  {
+    m_mappedBytes -= m_lru.back().second->GetSize();
+    m_files.erase(m_lru.back().first);
+    m_lru.pop_back();
+    m_evictions++;
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Cache of memory-mapped files served by the HTTP servers
+
+
+#ifndef HTTP_SERVER_FILE_CACHE_H
+#define HTTP_SERVER_FILE_CACHE_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <stdint.h>
+#include <string>
+#include <list>
+#include <unordered_map>
+
+
+namespace ns3
+{
+
+/**
+ * \brief Read-only memory mappings of the files on disk a HTTP server serves, shared by all of its client sockets
+ *
+ * Every file is mapped once, the client sockets send their replies directly from the mapped pages instead of
+ * reading a private copy of the file. At most maxMappedBytes bytes of files are kept mapped; the least recently
+ * used files are unmapped first. A file that is evicted while a client socket is still sending it stays mapped
+ * until the client socket releases it.
+ */
+class HttpServerFileCache
+{
+public:
+  /**
+   * \brief A read-only memory mapping of a whole file
+   */
+  class MappedFile : public SimpleRefCount<MappedFile>
+  {
+  public:
+    MappedFile(const uint8_t* data, uint64_t size);
+    ~MappedFile();
+
+    const uint8_t* GetData() const;
+    uint64_t GetSize() const;
+
+  private:
+    const uint8_t* m_data;
+    uint64_t m_size;
+  };
+
+  HttpServerFileCache(uint64_t maxMappedBytes = 64 * 1024 * 1024);
+  ~HttpServerFileCache();
+
+  /**
+   * \brief Set the maximum number of bytes of files that are kept mapped, evicting files if needed
+   */
+  void SetMaxMappedBytes(uint64_t maxMappedBytes);
+
+  /**
+   * \brief Get the mapping of a file, mapping it on the first request
+   * \return 0 if the file can not be opened or mapped
+   */
+  Ptr<const MappedFile> Get(const std::string& path);
+
+  /**
+   * \brief Unmap all files that are not sent anymore
+   */
+  void Clear();
+
+protected:
+  static Ptr<MappedFile> Map(const std::string& path);
+
+  /**
+   * \brief Unmap the least recently used files until at most m_maxMappedBytes bytes are mapped
+   */
+  void Evict();
+
+  typedef std::list<std::pair<std::string /* path */, Ptr<MappedFile> > > LruList;
+
+  LruList m_lru; ///< \brief the mapped files, the most recently used first
+  std::unordered_map<std::string /* path */, LruList::iterator> m_files;
+
+  uint64_t m_maxMappedBytes;
+  uint64_t m_mappedBytes;
+
+  uint64_t m_hits;
+  uint64_t m_misses;
+  uint64_t m_evictions;
+};
+
+} // namespace ns3
+
+
+#endif /* HTTP_SERVER_FILE_CACHE_H */
@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Catalog of the files served by the HTTP servers
+
+#include "http-server-file-catalog.h"
+
+#include <sstream>
+
+
+namespace ns3
+{
+
+HttpServerFileCatalog::HttpServerFileCatalog()
+{
+}
+
+
+void
+HttpServerFileCatalog::AddFile(const std::string& path, long size)
+{
+  FileEntry& entry = m_files[path];
+  entry.size = size;
+  entry.isVirtual = false;
+  entry.isHosted = false;
+  entry.contents.clear();
+}
+
+
+void
+HttpServerFileCatalog::AddVirtualFile(const std::string& path, long size)
+{
+  FileEntry& entry = m_files[path];
+  entry.size = size;
+  entry.isVirtual = true;
+  entry.isHosted = false;
+  entry.contents.clear();
+}
+
+
+void
+HttpServerFileCatalog::AddHostedFile(const std::string& path, const std::string& contents)
+{
+  FileEntry& entry = m_files[path];
+  entry.size = contents.size();
+  entry.isVirtual = false;
+  entry.isHosted = true;
+  entry.contents = contents;
+}
+
+
+uint32_t
+HttpServerFileCatalog::AddDASHVideo(const std::string& segmentDirectory)
+{
+  uint32_t video = m_videos.size();
+  m_videos.push_back(DASHVideo());
+  m_videoDirectories[segmentDirectory] = video;
+  return video;
+}
+
+
+void
+HttpServerFileCatalog::AddDASHRepresentation(uint32_t video, const std::string& reprId, uint32_t numberOfSegments, long segmentSize)
+{
+  DASHRepresentation& repr = m_videos.at(video).representations[reprId];
+  repr.numberOfSegments = numberOfSegments;
+  repr.segmentSize = segmentSize;
+  repr.segmentSizes.clear();
+}
+
+
+void
+HttpServerFileCatalog::AddDASHRepresentation(uint32_t video, const std::string& reprId, const std::vector<long>& segmentSizes)
+{
+  DASHRepresentation& repr = m_videos.at(video).representations[reprId];
+  repr.numberOfSegments = segmentSizes.size();
+  repr.segmentSize = 0;
+  repr.segmentSizes = segmentSizes;
+}
+
+
+bool
+HttpServerFileCatalog::Find(const std::string& path, FileInfo& info) const
+{
+  std::unordered_map<std::string, FileEntry>::const_iterator it = m_files.find(path);
+  if (it != m_files.end())
+  {
+    info.size = it->second.size;
+    info.isVirtual = it->second.isVirtual;
+    info.contents = it->second.isHosted ? &it->second.contents : NULL;
+    return true;
+  }
+
+  return FindDASHSegment(path, info);
+}
+
+
+bool
+HttpServerFileCatalog::FindDASHSegment(const std::string& path, FileInfo& info) const
+{
+  if (m_videos.empty())
+  {
+    return false;
+  }
+
+  size_t slash = path.rfind('/');
+  if (slash == std::string::npos)
+  {
+    return false;
+  }
+
+  std::unordered_map<std::string, uint32_t>::const_iterator video = m_videoDirectories.find(path.substr(0, slash+1));
+  if (video == m_videoDirectories.end())
+  {
+    return false;
+  }
+
+  std::string reprId;
+  uint32_t segmentNr;
+  if (!ParseDASHSegmentName(path.substr(slash+1), reprId, segmentNr))
+  {
+    return false;
+  }
+
+  const DASHVideo& dashVideo = m_videos[video->second];
+  std::unordered_map<std::string, DASHRepresentation>::const_iterator repr = dashVideo.representations.find(reprId);
+  if (repr == dashVideo.representations.end() || segmentNr >= repr->second.numberOfSegments)
+  {
+    return false;
+  }
+
+  info.size = repr->second.segmentSizes.empty() ? repr->second.segmentSize : repr->second.segmentSizes[segmentNr];
+  info.isVirtual = true;
+  info.contents = NULL;
+  return true;
+}
+
+
+std::string
+HttpServerFileCatalog::GetDASHSegmentName(const std::string& reprId, uint32_t segmentNr)
+{
+  std::ostringstream segmentFileName;
+  segmentFileName << "repr_" << reprId << "_seg_" << segmentNr << ".264";
+  return segmentFileName.str();
+}
+
+
+bool
+HttpServerFileCatalog::ParseDASHSegmentName(const std::string& name, std::string& reprId, uint32_t& segmentNr)
+{
+  static const std::string prefix("repr_");
+  static const std::string separator("_seg_");
+  static const std::string suffix(".264");
+
+  if (name.size() <= prefix.size() + separator.size() + suffix.size()
+      || name.compare(0, prefix.size(), prefix) != 0
+      || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+  {
+    return false;
+  }
+
+  size_t pos = name.rfind(separator);
+  if (pos == std::string::npos || pos < prefix.size())
+  {
+    return false;
+  }
+
+  size_t digitsStart = pos + separator.size();
+  size_t digitsEnd = name.size() - suffix.size();
+  if (digitsStart >= digitsEnd)
+  {
+    return false;
+  }
+
+  uint64_t number = 0;
+  for (size_t i = digitsStart; i < digitsEnd; i++)
+  {
+    if (name[i] < '0' || name[i] > '9' || number > UINT32_MAX / 10)
+    {
+      return false;
+    }
+    number = number * 10 + (name[i] - '0');
+  }
+  if (number > UINT32_MAX)
+  {
+    return false;
+  }
+
+  reprId = name.substr(prefix.size(), pos - prefix.size());
+  segmentNr = number;
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Catalog of the files served by the HTTP servers
+
+
+#ifndef HTTP_SERVER_FILE_CATALOG_H
+#define HTTP_SERVER_FILE_CATALOG_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+
+namespace ns3
+{
+
+/**
+ * \brief Index of all files a HTTP server serves, shared by all of its client sockets
+ *
+ * Files with a size only (virtual files whose payload is generated, files on disk) and files hosted in
+ * memory (e.g., the generated MPDs) are kept in a hash map, so every lookup is O(1).
+ * DASH segments are not stored by name at all: a video only registers the directory its segments are
+ * served from and its representations, and the segment URL <directory>repr_<reprId>_seg_<segmentNr>.264
+ * is decoded when it is requested. The size of a segment is computed from its representation, so a
+ * constant bit rate representation takes the same memory regardless of its number of segments; only
+ * variable bit rate representations keep a table of segment sizes.
+ */
+class HttpServerFileCatalog
+{
+public:
+  /**
+   * \brief Result of a catalog lookup
+   */
+  struct FileInfo
+  {
+    long size;                    ///< \brief size of the file in bytes
+    bool isVirtual;               ///< \brief whether the payload is generated instead of read from disk or memory
+    const std::string* contents;  ///< \brief the contents of a file hosted in memory, NULL otherwise
+  };
+
+  HttpServerFileCatalog();
+
+  /**
+   * \brief Add a file on disk with its size
+   */
+  void AddFile(const std::string& path, long size);
+
+  /**
+   * \brief Add a virtual file, whose payload is generated when it is sent
+   */
+  void AddVirtualFile(const std::string& path, long size);
+
+  /**
+   * \brief Add a file hosted in memory
+   */
+  void AddHostedFile(const std::string& path, const std::string& contents);
+
+  /**
+   * \brief Add a DASH video with virtual segments
+   * \param segmentDirectory the directory the segments are served from, including the trailing '/'
+   * \return the index of the video for AddDASHRepresentation
+   */
+  uint32_t AddDASHVideo(const std::string& segmentDirectory);
+
+  /**
+   * \brief Add a constant bit rate representation to a DASH video
+   * \param video the index of the video as returned by AddDASHVideo
+   * \param reprId the id of the representation
+   * \param numberOfSegments the number of segments of the representation
+   * \param segmentSize the size of every segment of the representation in bytes
+   */
+  void AddDASHRepresentation(uint32_t video, const std::string& reprId, uint32_t numberOfSegments, long segmentSize);
+
+  /**
+   * \brief Add a variable bit rate representation to a DASH video
+   * \param video the index of the video as returned by AddDASHVideo
+   * \param reprId the id of the representation
+   * \param segmentSizes the size of every segment of the representation in bytes
+   */
+  void AddDASHRepresentation(uint32_t video, const std::string& reprId, const std::vector<long>& segmentSizes);
+
+  /**
+   * \brief Look up a file
+   * \return false if the catalog does not know the file
+   */
+  bool Find(const std::string& path, FileInfo& info) const;
+
+  /**
+   * \return the name of a DASH segment, relative to the segment directory of its video
+   */
+  static std::string GetDASHSegmentName(const std::string& reprId, uint32_t segmentNr);
+
+protected:
+  /**
+   * \brief Decode the name of a DASH segment
+   * \return false if name is not of the form repr_<reprId>_seg_<segmentNr>.264
+   */
+  static bool ParseDASHSegmentName(const std::string& name, std::string& reprId, uint32_t& segmentNr);
+
+  bool FindDASHSegment(const std::string& path, FileInfo& info) const;
+
+  struct FileEntry
+  {
+    long size;
+    bool isVirtual;
+    bool isHosted;
+    std::string contents;
+  };
+
+  struct DASHRepresentation
+  {
+    uint32_t numberOfSegments;
+    long segmentSize;               ///< \brief the size of every segment, if segmentSizes is empty
+    std::vector<long> segmentSizes; ///< \brief the size of every segment of a variable bit rate representation
+  };
+
+  struct DASHVideo
+  {
+    std::unordered_map<std::string /* repr id */, DASHRepresentation> representations;
+  };
+
+  std::unordered_map<std::string /* path */, FileEntry> m_files;
+  std::unordered_map<std::string /* segment directory */, uint32_t /* video */> m_videoDirectories;
+  std::vector<DASHVideo> m_videos;
+};
+
+} // namespace ns3
+
+
+#endif /* HTTP_SERVER_FILE_CATALOG_H */
@@ -83,6 +83,10 @@ HttpServerApplication::GetTypeId (void)
                    StringValue("/"),
                    MakeStringAccessor(&HttpServerApplication::m_metaDataContentDirectory),
                    MakeStringChecker())
+    .AddAttribute("FileCacheSize", "Maximum number of bytes of files on disk that are kept memory-mapped for all connections",
+                   UintegerValue(64 * 1024 * 1024),
+                   MakeUintegerAccessor(&HttpServerApplication::m_fileCacheSize),
+                   MakeUintegerChecker<uint64_t>())
     .AddAttribute("Hostname", "The (virtual) hostname of this server",
                    StringValue("localhost"),
                    MakeStringAccessor(&HttpServerApplication::m_hostName),
@@ -96,6 +100,7 @@ HttpServerApplication::GetTypeId (void)
 
 
 HttpServerApplication::HttpServerApplication ()
+  : m_socketPool(m_catalog, m_fileCache, MakeCallback(&HttpServerApplication::FinishedCallback, this))
 {
   NS_LOG_FUNCTION (this);
 
@@ -122,11 +127,18 @@ HttpServerApplication::ReportStats()
   uint64_t bytes_recv = m_bytes_recv - m_last_bytes_recv;
   uint64_t bytes_sent = m_bytes_sent - m_last_bytes_sent;
 
-  m_throughputTrace(this, bytes_sent, bytes_recv, m_activeClients.size());
+  // average number of Send calls of the replies finished since the last report
+  const HttpServerReplyStatistics& replyStatistics = m_socketPool.GetReplyStatistics();
+  uint64_t replies = replyStatistics.replies - m_last_reply_statistics.replies;
+  double sendCallsPerReply = replies > 0 ? (double)(replyStatistics.sendCalls - m_last_reply_statistics.sendCalls) / replies : 0.0;
+
+  m_throughputTrace(this, bytes_sent, bytes_recv, m_activeClients.size(),
+                    m_socketPool.GetIdle(), m_socketPool.GetAllocated(), m_socketPool.GetReused(), sendCallsPerReply);
 
 
   m_last_bytes_recv = m_bytes_recv;
   m_last_bytes_sent = m_bytes_sent;
+  m_last_reply_statistics = replyStatistics;
 
   if (m_active)
   {
@@ -163,12 +175,16 @@ HttpServerApplication::StartApplication (void)
 
   m_last_bytes_recv = 0;
   m_last_bytes_sent = 0;
+  m_last_reply_statistics = m_socketPool.GetReplyStatistics();
 
   m_bytes_recv = 0;
   m_bytes_sent = 0;
 
   m_lastSocketID = 1;
 
+  m_fileCache.SetMaxMappedBytes(m_fileCacheSize);
+  m_socketPool.SetContentDirectory(m_contentDir);
+
   if (m_socket == 0)
   {
     TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
@@ -212,7 +228,7 @@ HttpServerApplication::StartApplication (void)
 
   // parse meta data csv file
 
-  // read m_metaDataFile and fill m_fileSizes
+  // read m_metaDataFile and fill m_catalog
   std::ifstream infile(m_metaDataFile.c_str());
   if (!infile.is_open())
   {
@@ -232,11 +248,9 @@ HttpServerApplication::StartApplication (void)
         std::string line_filename = line.substr(0, pos);
         std::string line_filesize = line.substr(pos+1);
         //fprintf(stderr, "First=%s,Second=%s\n", line_filename.c_str(), line_filesize.c_str());
-        m_fileSizes[m_contentDir + m_metaDataContentDirectory + line_filename] = atoi(line_filesize.c_str());
+        m_catalog.AddVirtualFile(m_contentDir + m_metaDataContentDirectory + line_filename, atoi(line_filesize.c_str()));
 
         fprintf(stderr, "Added '%s' to the store!\n", (m_contentDir + m_metaDataContentDirectory + line_filename).c_str());
-
-        m_virtualFiles.push_back(m_contentDir + m_metaDataContentDirectory + line_filename);
       }
     }
   }
@@ -289,27 +303,27 @@ HttpServerApplication::ConnectionAccepted (Ptr<Socket> socket, const Address& ad
 
   uint64_t socket_id = RegisterSocket(socket);
 
-  m_activeClients[socket_id] = new HttpServerFakeClientSocket(socket_id, m_contentDir, m_fileSizes, m_virtualFiles,
-                  MakeCallback(&HttpServerApplication::FinishedCallback, this));
+  HttpServerFakeClientSocket* client = m_socketPool.Allocate(socket_id);
+  m_activeClients[socket_id] = client;
 
   NS_LOG_DEBUG (socket << " " << Simulator::Now () << " Successful socket id : " << socket_id << " Connection Accepted From " << address);
 
   // set callbacks for this socket to be in HttpServerFakeClientSocket class
-  socket->SetSendCallback (MakeCallback (&HttpServerFakeClientSocket::HandleReadyToTransmit, m_activeClients[socket_id]));
-  socket->SetRecvCallback (MakeCallback (&HttpServerFakeClientSocket::HandleIncomingData, m_activeClients[socket_id]));
+  socket->SetSendCallback (MakeCallback (&HttpServerFakeClientSocket::HandleReadyToTransmit, client));
+  socket->SetRecvCallback (MakeCallback (&HttpServerFakeClientSocket::HandleIncomingData, client));
 
 
   socket->TraceConnectWithoutContext ("State",
-    MakeCallback(&HttpServerFakeClientSocket::LogStateChange, m_activeClients[socket_id]));
+    MakeCallback(&HttpServerFakeClientSocket::LogStateChange, client));
 
 /*
   socket->TraceConnectWithoutContext ("CongestionWindow",
-    MakeCallback(&HttpServerFakeClientSocket::LogCwndChange, m_activeClients[socket_id]));
+    MakeCallback(&HttpServerFakeClientSocket::LogCwndChange, client));
 */
 
 
-  socket->SetCloseCallbacks (MakeCallback (&HttpServerFakeClientSocket::ConnectionClosedNormal, m_activeClients[socket_id]),
-                             MakeCallback (&HttpServerFakeClientSocket::ConnectionClosedError,  m_activeClients[socket_id]));
+  socket->SetCloseCallbacks (MakeCallback (&HttpServerFakeClientSocket::ConnectionClosedNormal, client),
+                             MakeCallback (&HttpServerFakeClientSocket::ConnectionClosedError,  client));
 }
 
 
@@ -319,19 +333,33 @@ HttpServerApplication::ConnectionAccepted (Ptr<Socket> socket, const Address& ad
 void
 HttpServerApplication::FinishedCallback (uint64_t socket_id)
 {
-  // create timer to finish this, because if we do it in here, we will crash the app
-  Simulator::Schedule(Seconds(1.0), &HttpServerApplication::DoFinishSocket, this, socket_id);
+  // the client socket calls this from within its socket callbacks, so it is finished after the current event
+  Simulator::ScheduleNow(&HttpServerApplication::DoFinishSocket, this, socket_id);
 }
 
 void
 HttpServerApplication::DoFinishSocket(uint64_t socket_id)
 {
-  if (m_activeClients.find(socket_id) != m_activeClients.end())
+  std::map<uint64_t, HttpServerFakeClientSocket*>::iterator it = m_activeClients.find(socket_id);
+  if (it == m_activeClients.end())
+    return;
+
+  HttpServerFakeClientSocket* client = it->second;
+  m_activeClients.erase(it);
+
+  // make sure the socket no longer calls the client socket, before it is reused for another connection
+  std::map<uint64_t, Ptr<Socket> >::iterator sit = m_activeSockets.find(socket_id);
+  if (sit != m_activeSockets.end())
   {
-    HttpServerFakeClientSocket* tmp = m_activeClients[socket_id];
-    m_activeClients.erase(socket_id);
-    delete tmp; // TODO: CHECK
+    Ptr<Socket> socket = sit->second;
+    socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+    socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+    socket->TraceDisconnectWithoutContext ("State", MakeCallback(&HttpServerFakeClientSocket::LogStateChange, client));
+    m_activeSockets.erase(sit);
   }
+
+  m_socketPool.Release(client);
 }
 
 
@@ -342,7 +370,7 @@ HttpServerApplication::DoFinishSocket(uint64_t socket_id)
 uint64_t
 HttpServerApplication::RegisterSocket (Ptr<Socket> socket)
 {
-  this->m_activeSockets[socket] = this->m_lastSocketID;
+  this->m_activeSockets[this->m_lastSocketID] = socket;
 
   return this->m_lastSocketID++;
 }
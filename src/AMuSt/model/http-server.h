@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "http-server-fake-clientsocket.h"
+#include "http-server-client-socket-pool.h"
 
 
 #define CRLF "\r\n"
@@ -77,6 +78,8 @@ protected:
   uint64_t m_last_bytes_recv;
   uint64_t m_last_bytes_sent;
 
+  HttpServerReplyStatistics m_last_reply_statistics; ///< \brief reply statistics of the socket pool at the last report
+
 
   bool ConnectionRequested (Ptr<Socket> socket, const Address& address);
   void ConnectionAccepted (Ptr<Socket> socket, const Address& address);
@@ -89,18 +92,24 @@ protected:
 
 
   TracedCallback<Ptr<ns3::Application> /*App*/,
-    uint64_t /* TxBytes*/,uint64_t /* RxBytes */, uint32_t /* ConnectionCount */> m_throughputTrace;
+    uint64_t /* TxBytes*/,uint64_t /* RxBytes */, uint32_t /* ConnectionCount */,
+    uint32_t /* IdleSocketHandlers */, uint64_t /* AllocatedSocketHandlers */, uint64_t /* ReusedSocketHandlers */,
+    double /* SendCallsPerReply */> m_throughputTrace;
 
 private:
-  std::map<Ptr<Socket> /* socket */, uint64_t /* socket id */  > m_activeSockets;
+  std::map<uint64_t /* socket id */, Ptr<Socket> /* socket */ > m_activeSockets;
 
   std::map<uint64_t /* socket id */, HttpServerFakeClientSocket* /* client_socket */ > m_activeClients;
 
 
   std::map<uint64_t /* socket id */, std::string /* packet buffer */ > m_activePackets;
 
-  std::map<std::string, long> m_fileSizes;
-  std::vector<std::string> m_virtualFiles;
+  HttpServerFileCatalog m_catalog; ///< \brief the virtual files served by this server
+
+  HttpServerFileCache m_fileCache; ///< \brief the files on disk served by this server, memory-mapped
+  uint64_t m_fileCacheSize;
+
+  HttpServerClientSocketPool<HttpServerFakeClientSocket> m_socketPool; ///< \brief the handlers of the client sockets, reused for new connections
 
   uint64_t m_lastSocketID;
 
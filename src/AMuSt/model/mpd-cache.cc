@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Cache of parsed MPDs, shared by all multimedia consumers
+
+#include "mpd-cache.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/system-path.h"
+#include "ns3/string.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("MpdCache");
+
+std::unordered_map<std::string, dash::mpd::IMPD*> MpdCache::s_mpds;
+uint64_t MpdCache::s_hits = 0;
+
+
+const dash::mpd::IMPD*
+MpdCache::Get(const std::string& mpdData)
+{
+  std::unordered_map<std::string, dash::mpd::IMPD*>::const_iterator it = s_mpds.find(mpdData);
+  if (it != s_mpds.end())
+  {
+    s_hits++;
+    return it->second;
+  }
+
+  if (s_mpds.empty())
+  {
+    Simulator::ScheduleDestroy(&MpdCache::Clear);
+  }
+
+  // failed parses are cached as well, so that a broken MPD is not parsed again by every client
+  dash::mpd::IMPD* mpd = Parse(mpdData);
+  s_mpds[mpdData] = mpd;
+
+  fprintf(stderr, "MpdCache: parsed MPD of %lu bytes, %lu MPDs cached\n", (unsigned long) mpdData.size(), (unsigned long) s_mpds.size());
+  return mpd;
+}
+
+
+void
+MpdCache::Clear()
+{
+  fprintf(stderr, "MpdCache: %lu MPDs parsed, %lu times reused\n", (unsigned long) s_mpds.size(), (unsigned long) s_hits);
+
+  for (std::unordered_map<std::string, dash::mpd::IMPD*>::iterator it = s_mpds.begin(); it != s_mpds.end(); ++it)
+  {
+    delete it->second;
+  }
+  s_mpds.clear();
+  s_hits = 0;
+}
+
+
+dash::mpd::IMPD*
+MpdCache::Parse(const std::string& mpdData)
+{
+  // decompress the MPD in memory; if it was not gziped, we use it as is
+  std::string decompressed;
+  const std::string* xml = &mpdData;
+  try
+  {
+    decompressed = zlib_decompress_string(mpdData);
+    xml = &decompressed;
+  }
+  catch(std::exception& e)
+  {
+    NS_LOG_DEBUG(e.what() << " Assuming file was not zipped!");
+  }
+
+  // libdash only parses MPDs from a path, so the MPD is written once to a temporary file
+  std::stringstream ss_tempMpdFile;
+  ss_tempMpdFile << SystemPath::MakeTemporaryDirectoryName() << "-mpd-" << s_mpds.size() << ".xml";
+  std::string tempMpdFile = ss_tempMpdFile.str();
+
+  {
+    std::ofstream outfile( tempMpdFile.c_str(), std::ios_base::out | std::ios_base::binary );
+    outfile.write(xml->data(), xml->size());
+  }
+
+  NS_LOG_DEBUG("Parsing MPD " << tempMpdFile);
+
+  dash::IDASHManager *manager = CreateDashManager();
+  dash::mpd::IMPD* mpd = manager->Open((char*)tempMpdFile.c_str());
+
+  // We don't need the manager anymore, nor the temporary file
+  manager->Delete();
+
+  if (remove(tempMpdFile.c_str()) != 0)
+  {
+    fprintf(stderr, "Error: could not delete file '%s'.\n", tempMpdFile.c_str());
+  }
+
+  if (mpd == NULL)
+  {
+    NS_LOG_ERROR("Error parsing mpd " << tempMpdFile);
+  }
+
+  return mpd;
+}
+
+} // namespace ns3
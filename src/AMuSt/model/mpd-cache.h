@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Cache of parsed MPDs, shared by all multimedia consumers
+
+
+#ifndef MPD_CACHE_H
+#define MPD_CACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "libdash.h"
+
+
+namespace ns3
+{
+
+/**
+ * \brief Cache of parsed MPDs, shared by all multimedia consumers of a simulation
+ *
+ * MPDs are keyed by the downloaded (usually gzip compressed) bytes, so every distinct MPD is decompressed
+ * and parsed once, no matter how many clients download it. The parsed MPDs are immutable and owned by
+ * the cache; consumers must not delete them. They are deleted when the simulator is destroyed.
+ */
+class MpdCache
+{
+public:
+  /**
+   * \brief Get the parsed MPD for the downloaded bytes, decompressing and parsing them on the first request
+   * \param mpdData the downloaded MPD, gzip compressed or not
+   * \return the shared MPD, NULL if it could not be parsed
+   */
+  static const dash::mpd::IMPD* Get(const std::string& mpdData);
+
+  /**
+   * \brief Delete all cached MPDs
+   */
+  static void Clear();
+
+protected:
+  static dash::mpd::IMPD* Parse(const std::string& mpdData);
+
+  static std::unordered_map<std::string /* downloaded MPD */, dash::mpd::IMPD*> s_mpds;
+  static uint64_t s_hits;
+};
+
+} // namespace ns3
+
+
+#endif /* MPD_CACHE_H */
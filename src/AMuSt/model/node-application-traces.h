@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// Copyright (c) 2015 Christian Kreuzberger, Alpen-Adria-Universitaet Klagenfurt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+// ns3 - Connecting the tracers to the trace sources of the applications of a node
+
+
+#ifndef NODE_APPLICATION_TRACES_H
+#define NODE_APPLICATION_TRACES_H
+
+#include "ns3/node.h"
+#include "ns3/application.h"
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \brief Connect callback to the trace source traceSource of every application of node
+ *
+ * Cheaper than resolving a config path with an application wildcard, which walks the whole object namespace
+ * for every node; applications without the trace source are skipped, like the wildcard does.
+ */
+inline void
+ConnectApplicationTraces(Ptr<Node> node, const std::string& traceSource, const CallbackBase& callback)
+{
+  for (uint32_t i = 0; i < node->GetNApplications(); i++)
+  {
+    node->GetApplication(i)->TraceConnectWithoutContext(traceSource, callback);
+  }
+}
+
+} // namespace ns3
+
+#endif /* NODE_APPLICATION_TRACES_H */
@@ -10,6 +10,7 @@
 #include "ns3/boolean.h"
 #include "ns3/core-module.h"
 #include "ns3/trace-source-accessor.h"
+#include "node-application-traces.h"
 
 #include <boost/shared_ptr.hpp>
 
@@ -135,7 +136,7 @@ NodeThroughputTracer::NodeThroughputTracer(boost::shared_ptr<std::ofstream> os,
 
   m_node = node_id_str.str();
 
-  Connect();
+  ConnectApplicationTraces(m_nodePtr, "ThroughputTracer", MakeCallback(&NodeThroughputTracer::ThroughputStats, this));
 }
 
 NodeThroughputTracer::NodeThroughputTracer(boost::shared_ptr<std::ofstream> os, const std::string& node)
@@ -162,14 +163,17 @@ NodeThroughputTracer::Connect()
 void
 NodeThroughputTracer::PrintHeader(std::ofstream& os) const
 {
-  os << "Time\tNode\tTxBytes\tRxBytes\tOpenSockets";
+  os << "Time\tNode\tTxBytes\tRxBytes\tOpenSockets\tIdleHandlers\tAllocatedHandlers\tReusedHandlers\tSendCallsPerReply";
 }
 
 void
-NodeThroughputTracer::ThroughputStats(Ptr<ns3::Application> app, uint64_t txBytes, uint64_t rxBytes, uint32_t openSockets)
+NodeThroughputTracer::ThroughputStats(Ptr<ns3::Application> app, uint64_t txBytes, uint64_t rxBytes, uint32_t openSockets,
+                                      uint32_t idleSocketHandlers, uint64_t allocatedSocketHandlers, uint64_t reusedSocketHandlers,
+                                      double sendCallsPerReply)
 {
   (*m_os) << Simulator::Now().ToDouble(Time::S) << "\t" << m_node << "\t"
-        << txBytes << "\t" << rxBytes << "\t" << openSockets << "\n";
+        << txBytes << "\t" << rxBytes << "\t" << openSockets << "\t"
+        << idleSocketHandlers << "\t" << allocatedSocketHandlers << "\t" << reusedSocketHandlers << "\t" << sendCallsPerReply << "\n";
 
 
   (*m_os).flush();
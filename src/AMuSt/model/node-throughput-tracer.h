@@ -122,7 +122,9 @@ private:
   Connect();
 
   void
-  ThroughputStats(Ptr<ns3::Application> app, uint64_t txBytes, uint64_t rxBytes, uint32_t connectionCount);
+  ThroughputStats(Ptr<ns3::Application> app, uint64_t txBytes, uint64_t rxBytes, uint32_t connectionCount,
+                  uint32_t idleSocketHandlers, uint64_t allocatedSocketHandlers, uint64_t reusedSocketHandlers,
+                  double sendCallsPerReply);
 
 private:
   std::string m_node;
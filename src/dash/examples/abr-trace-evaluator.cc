@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Evaluates adaptation algorithms on recorded throughput traces, without the network stack
+// - Traces are read from throughput logs, or from download logs (files ending in downloadLog.txt) if the throughput was sampled per segment
+// - Every trace is replayed sessionsPerTrace times per algorithm, starting at evenly spaced offsets into the trace
+// - The metrics of every session are written to the output file, the averages per algorithm to stdout
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "ns3/core-module.h"
+#include "ns3/abr-trace-evaluator.h"
+#include "ns3/segment-size-manifest.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("AbrTraceEvaluator");
+
+static std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> items;
+  std::stringstream stream (list);
+  std::string item;
+  while (std::getline (stream, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+static bool
+IsDownloadLog (std::string path)
+{
+  std::string suffix = "downloadLog.txt";
+  return path.size () >= suffix.size () && path.compare (path.size () - suffix.size (), suffix.size (), suffix) == 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string segmentSizeFilePath = "contrib/dash/segmentSizes.txt";
+  uint64_t segmentDuration = 2000000;
+  std::string adaptationAlgos = "tobasco,panda,festive";
+  std::string traces;
+  uint32_t sessionsPerTrace = 10;
+  uint32_t binSize = 100;
+  uint32_t requestDelay = 0;
+  std::string outputFile = "abr-trace-evaluation.txt";
+
+  CommandLine cmd;
+  cmd.Usage ("Evaluate adaptation algorithms by replaying throughput traces without the network stack.\n");
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("segmentDuration", "The duration of a segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "Comma separated list of the adaptation algorithms to evaluate", adaptationAlgos);
+  cmd.AddValue ("traces", "Comma separated list of throughput log files, e.g. dash-log-files/tobasco/1/sim1_cl0_throughputLog.txt, or of download log files for clients with ThroughputSampling Segment", traces);
+  cmd.AddValue ("sessionsPerTrace", "Number of sessions per trace and algorithm, starting at evenly spaced offsets into the trace", sessionsPerTrace);
+  cmd.AddValue ("binSize", "Duration in milliseconds of the time bins the trace is averaged over", binSize);
+  cmd.AddValue ("requestDelay", "Time in microseconds from sending a request until the first byte of the segment arrives", requestDelay);
+  cmd.AddValue ("output", "File the metrics of every session are written to", outputFile);
+  cmd.Parse (argc, argv);
+
+  Ptr<const videoData> video = SegmentSizeManifest::Get (segmentSizeFilePath, segmentDuration);
+  if (video == 0)
+    {
+      std::cerr << "Reading segment size file " << segmentSizeFilePath << " failed.\n";
+      return 1;
+    }
+  std::vector<std::string> algorithms = SplitList (adaptationAlgos);
+  std::vector<std::string> traceFiles = SplitList (traces);
+  std::vector<Ptr<ThroughputTrace> > throughputTraces;
+  for (size_t i = 0; i < traceFiles.size (); i++)
+    {
+      Ptr<ThroughputTrace> trace;
+      if (IsDownloadLog (traceFiles[i]))
+        {
+          trace = ThroughputTrace::ReadDownloadLog (traceFiles[i], binSize * 1000);
+        }
+      else
+        {
+          trace = ThroughputTrace::ReadThroughputLog (traceFiles[i], binSize * 1000);
+        }
+      if (trace == 0)
+        {
+          std::cerr << "Reading throughput trace " << traceFiles[i] << " failed.\n";
+          return 1;
+        }
+      throughputTraces.push_back (trace);
+    }
+  if (throughputTraces.empty () || algorithms.empty () || sessionsPerTrace == 0)
+    {
+      std::cerr << "Nothing to evaluate, see --PrintHelp.\n";
+      return 1;
+    }
+
+  std::ofstream output (outputFile.c_str ());
+  output << "Algorithm Trace Offset Average_Bitrate Switches Stalls Stall_Duration Startup_Delay Session_Duration\n";
+  std::cout << " Algorithm Sessions Average_Bitrate   Switches     Stalls Stall_Duration Startup_Delay\n";
+
+  uint64_t sessions = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (size_t a = 0; a < algorithms.size (); a++)
+    {
+      abrSessionMetrics sum = {0, 0, 0, 0, 0, 0};
+      for (size_t t = 0; t < throughputTraces.size (); t++)
+        {
+          for (uint32_t s = 0; s < sessionsPerTrace; s++)
+            {
+              int64_t offset = throughputTraces[t]->GetDuration () / sessionsPerTrace * s;
+              AbrTraceSession session (video, algorithms[a], throughputTraces[t], offset, requestDelay);
+              abrSessionMetrics metrics;
+              if (!session.Run (metrics))
+                {
+                  std::cerr << "Unknown adaptation algorithm " << algorithms[a] << ".\n";
+                  return 1;
+                }
+              output << algorithms[a] << " " << traceFiles[t] << " " << offset / (double)1000000 << " "
+                     << metrics.averageBitrate << " " << metrics.numberOfSwitches << " " << metrics.numberOfStalls << " "
+                     << metrics.stallDuration / (double)1000000 << " " << metrics.startupDelay / (double)1000000 << " "
+                     << metrics.sessionDuration / (double)1000000 << "\n";
+              sum.averageBitrate += metrics.averageBitrate;
+              sum.numberOfSwitches += metrics.numberOfSwitches;
+              sum.numberOfStalls += metrics.numberOfStalls;
+              sum.stallDuration += metrics.stallDuration;
+              sum.startupDelay += metrics.startupDelay;
+              sessions++;
+            }
+        }
+      double n = throughputTraces.size () * sessionsPerTrace;
+      std::cout << std::setw (10) << algorithms[a] << " "
+                << std::setw (8) << n << " "
+                << std::setw (15) << sum.averageBitrate / n << " "
+                << std::setw (10) << sum.numberOfSwitches / n << " "
+                << std::setw (10) << sum.numberOfStalls / n << " "
+                << std::setw (14) << sum.stallDuration / n / 1000000 << " "
+                << std::setw (13) << sum.startupDelay / n / 1000000 << "\n";
+    }
+  double wallClock = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  std::cout << sessions << " sessions in " << wallClock << " s, " << sessions / wallClock << " sessions per second\n";
+  return 0;
+}
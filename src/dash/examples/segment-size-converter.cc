@@ -0,0 +1,57 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Converts a text segment size matrix into the binary segment size format
+//   which TcpStreamClient memory-maps at load, see SegmentSizeManifest.
+
+#include "ns3/core-module.h"
+#include "ns3/segment-size-manifest.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SegmentSizeConverter");
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t segmentDuration = 2000000;
+  std::string inputFile;
+  std::string outputFile;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a text segment size file into the binary segment size format.\n");
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("input", "The text file containing the segment sizes in bytes", inputFile);
+  cmd.AddValue ("output", "The binary file to write", outputFile);
+  cmd.Parse (argc, argv);
+
+  Ptr<const videoData> manifest = SegmentSizeManifest::Get (inputFile, segmentDuration);
+  if (manifest == 0)
+    {
+      std::cerr << "Opening segment size file " << inputFile << " failed.\n";
+      return 1;
+    }
+  if (!SegmentSizeManifest::WriteBinaryFile (manifest, outputFile))
+    {
+      std::cerr << "Writing binary segment size file " << outputFile << " failed.\n";
+      return 1;
+    }
+  std::cout << "Wrote " << manifest->averageBitrate.size () << " representations x "
+            << manifest->numberOfSegments << " segments to " << outputFile << "\n";
+  return 0;
+}
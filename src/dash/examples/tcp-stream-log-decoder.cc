@@ -0,0 +1,55 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Converts the binary log file of a tcp-stream simulation run with
+//   ns3::TcpStreamClient::LogFormat=Binary into the per-client text log files.
+
+#include "ns3/core-module.h"
+#include "ns3/tcp-stream-log-sink.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamLogDecoder");
+
+int
+main (int argc, char *argv[])
+{
+  std::string inputFile;
+  std::string outputPrefix;
+
+  CommandLine cmd;
+  cmd.Usage ("Decode a binary tcp-stream log file into the per-client text log files.\n");
+  cmd.AddValue ("input", "The binary log file, e.g. dash-log-files/panda/3/sim1_log.bin", inputFile);
+  cmd.AddValue ("outputPrefix", "Path prefix of the text log files, by default the input path without log.bin", outputPrefix);
+  cmd.Parse (argc, argv);
+
+  if (outputPrefix.empty ())
+    {
+      std::string::size_type pos = inputFile.rfind ("log.bin");
+      outputPrefix = (pos == std::string::npos) ? inputFile + "_" : inputFile.substr (0, pos);
+    }
+
+  int64_t records = TcpStreamBinaryLogSink::Decode (inputFile, outputPrefix);
+  if (records < 0)
+    {
+      std::cerr << "Reading binary log file " << inputFile << " failed.\n";
+      return 1;
+    }
+  std::cout << "Decoded " << records << " records from " << inputFile << "\n";
+  return 0;
+}
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Benchmark of the TCP Stream server
+// - All clients run on a single node, connected to the server node with a point-to-point link
+// - For every number of clients, the number of server callbacks handled per second of wall-clock time is reported
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-server.h"
+#include "ns3/tcp-stream-client.h"
+#include "ns3/tcp-stream-interface.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamServerBenchmark");
+
+static void
+RunBenchmark (uint32_t numberOfClients, double simulationTime, std::string adaptationAlgo, std::string segmentSizeFilePath)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<Node> serverNode = nodes.Get (0);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("76.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  Address serverAddress = Address (interfaces.GetAddress (0));
+  uint16_t port = 9;
+
+  std::string dirstr (dashLogDirectory + adaptationAlgo + "/" + std::to_string (numberOfClients) + "/");
+  mkdir (dashLogDirectory.c_str (), 0775);
+  mkdir ((dashLogDirectory + adaptationAlgo).c_str (), 0775);
+  mkdir (dirstr.c_str (), 0775);
+
+  TcpStreamServerHelper serverHelper (port);
+  ApplicationContainer serverApp = serverHelper.Install (serverNode);
+  serverApp.Start (Seconds (1.0));
+
+  std::vector <std::pair <Ptr<Node>, std::string> > clients;
+  for (uint32_t i = 0; i < numberOfClients; i++)
+    {
+      clients.push_back (std::make_pair (nodes.Get (1), adaptationAlgo));
+    }
+  TcpStreamClientHelper clientHelper (serverAddress, port);
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue (numberOfClients));
+  clientHelper.SetAttribute ("LogFormat", EnumValue (TcpStreamClient::LOG_BINARY));
+  clientHelper.SetAttribute ("ThroughputSampling", EnumValue (TcpStreamClient::THROUGHPUT_SEGMENT));
+  ApplicationContainer clientApps = clientHelper.Install (clients);
+  for (uint32_t i = 0; i < clientApps.GetN (); i++)
+    {
+      clientApps.Get (i)->SetStartTime (Seconds (2.0 + i * 1e-4));
+    }
+
+  Simulator::Stop (Seconds (simulationTime));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  double wallClock = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  uint64_t events = serverApp.Get (0)->GetObject<TcpStreamServer> ()->GetHandledEvents ();
+  std::cout << std::setw (8) << numberOfClients << " "
+            << std::setw (14) << events << " "
+            << std::setw (12) << wallClock << " "
+            << std::setw (14) << events / wallClock << "\n";
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string numbersOfClients = "1000,10000";
+  double simulationTime = 20.0;
+  std::string adaptationAlgo = "tobasco";
+  std::string segmentSizeFilePath = "contrib/dash/segmentSizes.txt";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark of the TCP Stream server with a growing number of clients.\n");
+  cmd.AddValue ("numbersOfClients", "Comma separated list of the numbers of clients to benchmark", numbersOfClients);
+  cmd.AddValue ("simulationTime", "Simulated time in seconds of every run", simulationTime);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithm that the clients use", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+
+  std::cout << " Clients Server_Events  Wall_Time_s Events_Per_Sec\n";
+  std::stringstream list (numbersOfClients);
+  std::string item;
+  while (std::getline (list, item, ','))
+    {
+      RunBenchmark (std::atoi (item.c_str ()), simulationTime, adaptationAlgo, segmentSizeFilePath);
+    }
+  return 0;
+}
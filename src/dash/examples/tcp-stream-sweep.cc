@@ -0,0 +1,371 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// - Runs the tcp-stream example for every combination of a grid of adaptation algorithms, numbers of clients
+//   and simulation ids, as independent worker processes in parallel, one per core by default
+// - Every run works in its own directory <sweepDirectory>/<algo>_<clients>_sim<id>/, which holds its
+//   dash-log-files subtree, its pcap files and its console output
+// - Every run uses the simulation id as ns-3 run number, so runs of different simulation ids draw from
+//   independent random number streams, while runs sharing a simulation id see the same client positions
+// - After all runs finished, a summary table of all runs is written to <sweepDirectory>/summary.txt
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/segment-size-manifest.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-log-sink.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamSweep");
+
+/**
+ * One combination of the parameter grid.
+ */
+struct sweepRun
+{
+  std::string adaptationAlgo;
+  uint32_t numberOfClients;
+  uint32_t simulationId;
+  std::string directory;
+  int exitStatus;
+  double wallClock;
+  std::chrono::steady_clock::time_point start;
+};
+
+static std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> items;
+  std::stringstream stream (list);
+  std::string item;
+  while (std::getline (stream, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+// expands a comma separated list of numbers and ranges like 1-10
+static std::vector<uint32_t>
+ParseNumbers (std::string list)
+{
+  std::vector<uint32_t> numbers;
+  std::vector<std::string> items = SplitList (list);
+  for (size_t i = 0; i < items.size (); i++)
+    {
+      std::string::size_type dash = items[i].find ('-');
+      uint32_t first = std::atoi (items[i].substr (0, dash).c_str ());
+      uint32_t last = (dash == std::string::npos) ? first : std::atoi (items[i].substr (dash + 1).c_str ());
+      for (uint32_t n = first; n <= last; n++)
+        {
+          numbers.push_back (n);
+        }
+    }
+  return numbers;
+}
+
+static std::string
+AbsolutePath (std::string path)
+{
+  char resolved[PATH_MAX];
+  if (realpath (path.c_str (), resolved) == NULL)
+    {
+      return path;
+    }
+  return std::string (resolved);
+}
+
+// starts the tcp-stream program for a run in the run's own directory, returns the pid of the worker
+static pid_t
+StartRun (const sweepRun &run, std::string program, std::string segmentSizeFilePath, uint64_t segmentDuration,
+          std::string extraArgs)
+{
+  std::vector<std::string> args;
+  args.push_back (program);
+  args.push_back ("--simulationId=" + std::to_string (run.simulationId));
+  args.push_back ("--numberOfClients=" + std::to_string (run.numberOfClients));
+  args.push_back ("--adaptationAlgo=" + run.adaptationAlgo);
+  args.push_back ("--segmentDuration=" + std::to_string (segmentDuration));
+  args.push_back ("--segmentSizeFile=" + segmentSizeFilePath);
+  args.push_back ("--RngRun=" + std::to_string (run.simulationId));
+  std::stringstream extra (extraArgs);
+  std::string arg;
+  while (extra >> arg)
+    {
+      args.push_back (arg);
+    }
+
+  // nothing buffered may be written twice by parent and worker
+  std::cout.flush ();
+  fflush (stdout);
+  pid_t pid = fork ();
+  if (pid != 0)
+    {
+      return pid;
+    }
+  // worker process
+  std::vector<char *> argv;
+  for (size_t i = 0; i < args.size (); i++)
+    {
+      argv.push_back (const_cast<char *> (args[i].c_str ()));
+    }
+  argv.push_back (NULL);
+  if (chdir (run.directory.c_str ()) != 0
+      || freopen ("output.txt", "w", stdout) == NULL
+      || freopen ("output.txt", "a", stderr) == NULL)
+    {
+      _exit (126);
+    }
+  execv (program.c_str (), &argv[0]);
+  _exit (127);
+}
+
+// collects the quality of experience of all clients of a finished run from its log files
+static void
+SummarizeRun (const sweepRun &run, Ptr<const videoData> video, std::ostream &summary)
+{
+  std::string logPrefix = run.directory + dashLogDirectory + run.adaptationAlgo + "/" + std::to_string (run.numberOfClients)
+    + "/sim" + std::to_string (run.simulationId) + "_";
+  struct stat binaryLog;
+  if (stat ((logPrefix + "log.bin").c_str (), &binaryLog) == 0)
+    {
+      TcpStreamBinaryLogSink::Decode (logPrefix + "log.bin", logPrefix);
+    }
+
+  int64_t segments = 0;
+  double bitrateSum = 0;
+  int64_t switches = 0;
+  int64_t stalls = 0;
+  double stallDuration = 0;
+  for (uint32_t client = 0; client < run.numberOfClients; client++)
+    {
+      std::string clientPrefix = logPrefix + "cl" + std::to_string (client) + "_";
+      std::ifstream playbackLog ((clientPrefix + "playbackLog.txt").c_str ());
+      std::string line;
+      int64_t lastRepIndex = -1;
+      while (std::getline (playbackLog, line))
+        {
+          std::istringstream fields (line);
+          int64_t segmentIndex;
+          double playbackStart;
+          int64_t repIndex;
+          if (!(fields >> segmentIndex >> playbackStart >> repIndex)
+              || repIndex < 0 || repIndex >= (int64_t) video->averageBitrate.size ())
+            {
+              continue;
+            }
+          segments++;
+          bitrateSum += video->averageBitrate[repIndex];
+          if (lastRepIndex >= 0 && repIndex != lastRepIndex)
+            {
+              switches++;
+            }
+          lastRepIndex = repIndex;
+        }
+
+      std::ifstream bufferUnderrunLog ((clientPrefix + "bufferUnderrunLog.txt").c_str ());
+      std::getline (bufferUnderrunLog, line);
+      double underrunStart;
+      double underrunEnd;
+      while (bufferUnderrunLog >> underrunStart)
+        {
+          stalls++;
+          if (bufferUnderrunLog >> underrunEnd)
+            {
+              stallDuration += underrunEnd - underrunStart;
+            }
+        }
+    }
+
+  double clients = std::max (run.numberOfClients, (uint32_t) 1);
+  summary << std::setw (10) << run.adaptationAlgo << " "
+          << std::setw (7) << run.numberOfClients << " "
+          << std::setw (13) << run.simulationId << " "
+          << std::setw (4) << run.exitStatus << " "
+          << std::setw (11) << run.wallClock << " "
+          << std::setw (15) << segments << " "
+          << std::setw (15) << (segments > 0 ? bitrateSum / segments : 0) << " "
+          << std::setw (19) << switches / clients << " "
+          << std::setw (17) << stalls / clients << " "
+          << std::setw (24) << stallDuration / clients << "\n";
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string adaptationAlgos = "tobasco";
+  std::string numbersOfClients = "1";
+  std::string simulationIds = "1";
+  uint64_t segmentDuration = 2000000;
+  std::string segmentSizeFilePath = "contrib/dash/segmentSizes.txt";
+  std::string sweepDirectory = "dash-sweep/";
+  std::string program;
+  std::string extraArgs;
+  long cores = sysconf (_SC_NPROCESSORS_ONLN);
+  uint32_t jobs = cores > 0 ? cores : 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Run the tcp-stream example for a grid of parameters in parallel worker processes.\n");
+  cmd.AddValue ("adaptationAlgo", "Comma separated list of adaptation algorithms", adaptationAlgos);
+  cmd.AddValue ("numberOfClients", "Comma separated list of numbers of clients, ranges like 1-10 included", numbersOfClients);
+  cmd.AddValue ("simulationId", "Comma separated list of simulation ids, ranges like 1-10 included", simulationIds);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("sweepDirectory", "Directory holding the directories of all runs and the summary", sweepDirectory);
+  cmd.AddValue ("program", "Path of the tcp-stream executable, by default next to this executable", program);
+  cmd.AddValue ("extraArgs", "Space separated arguments passed to every run, e.g. --ns3::TcpStreamClient::LogFormat=Binary", extraArgs);
+  cmd.AddValue ("jobs", "Number of runs executed in parallel, by default the number of cores", jobs);
+  cmd.Parse (argc, argv);
+
+  if (program.empty ())
+    {
+      // waf names the executables <prefix>tcp-stream-sweep<suffix> and <prefix>tcp-stream<suffix>
+      program = AbsolutePath (argv[0]);
+      std::string::size_type pos = program.rfind ("tcp-stream-sweep");
+      if (pos != std::string::npos)
+        {
+          program.replace (pos, std::string ("tcp-stream-sweep").size (), "tcp-stream");
+        }
+    }
+  program = AbsolutePath (program);
+  if (access (program.c_str (), X_OK) != 0)
+    {
+      std::cerr << "tcp-stream executable " << program << " not found, see --program.\n";
+      return 1;
+    }
+  // the runs work in their own directories, so they need the absolute path of the segment size file
+  Ptr<const videoData> video = SegmentSizeManifest::Get (segmentSizeFilePath, segmentDuration);
+  if (video == 0)
+    {
+      std::cerr << "Reading segment size file " << segmentSizeFilePath << " failed.\n";
+      return 1;
+    }
+  segmentSizeFilePath = AbsolutePath (segmentSizeFilePath);
+  if (sweepDirectory.empty () || sweepDirectory[sweepDirectory.size () - 1] != '/')
+    {
+      sweepDirectory += "/";
+    }
+  mkdir (sweepDirectory.c_str (), 0775);
+  jobs = std::max (jobs, (uint32_t) 1);
+
+  std::vector<sweepRun> runs;
+  std::vector<std::string> algorithms = SplitList (adaptationAlgos);
+  std::vector<uint32_t> clients = ParseNumbers (numbersOfClients);
+  std::vector<uint32_t> ids = ParseNumbers (simulationIds);
+  for (size_t a = 0; a < algorithms.size (); a++)
+    {
+      for (size_t c = 0; c < clients.size (); c++)
+        {
+          for (size_t i = 0; i < ids.size (); i++)
+            {
+              sweepRun run;
+              run.adaptationAlgo = algorithms[a];
+              run.numberOfClients = clients[c];
+              run.simulationId = ids[i];
+              run.directory = sweepDirectory + algorithms[a] + "_" + std::to_string (clients[c]) + "_sim" + std::to_string (ids[i]) + "/";
+              run.exitStatus = -1;
+              run.wallClock = 0;
+              runs.push_back (run);
+            }
+        }
+    }
+
+  std::cout << "Running " << runs.size () << " simulations with " << jobs << " parallel jobs using " << program << "\n";
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  std::map<pid_t, size_t> running;
+  size_t next = 0;
+  size_t failed = 0;
+  while (next < runs.size () || !running.empty ())
+    {
+      while (next < runs.size () && running.size () < jobs)
+        {
+          sweepRun &run = runs[next];
+          mkdir (run.directory.c_str (), 0775);
+          run.start = std::chrono::steady_clock::now ();
+          pid_t pid = StartRun (run, program, segmentSizeFilePath, segmentDuration, extraArgs);
+          if (pid < 0)
+            {
+              std::cerr << "Starting run in " << run.directory << " failed: " << strerror (errno) << "\n";
+              failed++;
+            }
+          else
+            {
+              running[pid] = next;
+            }
+          next++;
+        }
+      if (running.empty ())
+        {
+          continue;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          break;
+        }
+      std::map<pid_t, size_t>::iterator it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      sweepRun &run = runs[it->second];
+      running.erase (it);
+      run.wallClock = std::chrono::duration<double> (std::chrono::steady_clock::now () - run.start).count ();
+      run.exitStatus = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+      if (run.exitStatus != 0)
+        {
+          failed++;
+        }
+      std::cout << "Finished " << run.directory << " with status " << run.exitStatus << " after " << run.wallClock << " s\n";
+    }
+  double wallClock = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+  std::ofstream summary ((sweepDirectory + "summary.txt").c_str ());
+  summary << " Algorithm Clients Simulation_Id Exit Wall_Time_s Segments_Played Average_Bitrate Switches_Per_Client"
+          << " Stalls_Per_Client Stall_Duration_Per_Client\n";
+  for (size_t i = 0; i < runs.size (); i++)
+    {
+      SummarizeRun (runs[i], video, summary);
+    }
+  std::cout << runs.size () << " runs, " << failed << " failed, in " << wallClock << " s, summary in "
+            << sweepDirectory << "summary.txt\n";
+  return failed == 0 ? 0 : 1;
+}
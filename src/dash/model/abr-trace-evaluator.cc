@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "abr-trace-evaluator.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "tcp-stream-adaptation-algorithm.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <math.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AbrTraceSession");
+
+ThroughputTrace::ThroughputTrace (int64_t binSize, const std::vector<int64_t> &binBytes)
+  : m_binSize (binSize),
+    m_binBytes (binBytes.begin (), binBytes.end ())
+{
+  NS_ASSERT_MSG (m_binSize > 0, "The bin size must be positive");
+  // bins without bytes keep the capacity of the preceding bin, leading empty bins that of the first non-empty bin
+  std::vector<double>::iterator first = m_binBytes.begin ();
+  while (first != m_binBytes.end () && *first <= 0)
+    {
+      ++first;
+    }
+  NS_ASSERT_MSG (first != m_binBytes.end (), "A throughput trace needs at least one non-empty bin");
+  std::fill (m_binBytes.begin (), first, *first);
+  for (std::vector<double>::iterator it = first; it != m_binBytes.end (); ++it)
+    {
+      if (*it <= 0)
+        {
+          *it = *(it - 1);
+        }
+    }
+
+  m_cumulativeBytes.reserve (m_binBytes.size () + 1);
+  m_cumulativeBytes.push_back (0.0);
+  for (size_t i = 0; i < m_binBytes.size (); i++)
+    {
+      m_cumulativeBytes.push_back (m_cumulativeBytes.back () + m_binBytes[i]);
+    }
+}
+
+Ptr<ThroughputTrace>
+ThroughputTrace::ReadThroughputLog (std::string path, int64_t binSize)
+{
+  NS_LOG_FUNCTION (path << binSize);
+  std::ifstream file (path.c_str ());
+  if (!file)
+    {
+      NS_LOG_ERROR ("Couldn't open throughput log " << path);
+      return 0;
+    }
+  std::vector<int64_t> binBytes;
+  int64_t totalBytes = 0;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      std::istringstream fields (line);
+      double timeNow;
+      int64_t bytes;
+      if (!(fields >> timeNow >> bytes) || timeNow < 0 || bytes < 0)
+        {
+          continue;
+        }
+      size_t bin = (size_t) (llround (timeNow * 1000000) / binSize);
+      if (bin >= binBytes.size ())
+        {
+          binBytes.resize (bin + 1, 0);
+        }
+      binBytes[bin] += bytes;
+      totalBytes += bytes;
+    }
+  if (totalBytes == 0)
+    {
+      NS_LOG_ERROR ("Throughput log " << path << " contains no received bytes");
+      return 0;
+    }
+  return Create<ThroughputTrace> (binSize, binBytes);
+}
+
+Ptr<ThroughputTrace>
+ThroughputTrace::ReadDownloadLog (std::string path, int64_t binSize)
+{
+  NS_LOG_FUNCTION (path << binSize);
+  std::ifstream file (path.c_str ());
+  if (!file)
+    {
+      NS_LOG_ERROR ("Couldn't open download log " << path);
+      return 0;
+    }
+  std::vector<double> spreadBytes;
+  int64_t totalBytes = 0;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      std::istringstream fields (line);
+      int64_t segmentIndex;
+      double requestSent, transmissionStart, transmissionEnd;
+      int64_t bytes;
+      if (!(fields >> segmentIndex >> requestSent >> transmissionStart >> transmissionEnd >> bytes)
+          || requestSent < 0 || transmissionEnd < requestSent || bytes < 0)
+        {
+          continue;
+        }
+      int64_t begin = llround (requestSent * 1000000);
+      int64_t end = std::max ((int64_t) llround (transmissionEnd * 1000000), begin + 1);
+      size_t lastBin = (size_t) ((end - 1) / binSize);
+      if (lastBin >= spreadBytes.size ())
+        {
+          spreadBytes.resize (lastBin + 1, 0.0);
+        }
+      for (size_t bin = (size_t) (begin / binSize); bin <= lastBin; bin++)
+        {
+          int64_t overlap = std::min (end, (int64_t) (bin + 1) * binSize) - std::max (begin, (int64_t) bin * binSize);
+          spreadBytes[bin] += (double) bytes * overlap / (end - begin);
+        }
+      totalBytes += bytes;
+    }
+  if (totalBytes == 0)
+    {
+      NS_LOG_ERROR ("Download log " << path << " contains no received bytes");
+      return 0;
+    }
+  std::vector<int64_t> binBytes (spreadBytes.size ());
+  for (size_t i = 0; i < spreadBytes.size (); i++)
+    {
+      binBytes[i] = llround (spreadBytes[i]);
+    }
+  return Create<ThroughputTrace> (binSize, binBytes);
+}
+
+int64_t
+ThroughputTrace::GetDuration (void) const
+{
+  return m_binSize * m_binBytes.size ();
+}
+
+double
+ThroughputTrace::GetBytesUntil (int64_t offset) const
+{
+  size_t bin = offset / m_binSize;
+  return m_cumulativeBytes[bin] + m_binBytes[bin] * (offset - (int64_t) bin * m_binSize) / m_binSize;
+}
+
+int64_t
+ThroughputTrace::GetTransferEnd (int64_t start, int64_t bytes) const
+{
+  int64_t duration = GetDuration ();
+  int64_t lap = start / duration;
+  double target = GetBytesUntil (start - lap * duration) + bytes;
+  double total = m_cumulativeBytes.back ();
+  int64_t laps = (int64_t) floor (target / total);
+  double rest = target - laps * total;
+  size_t bin = std::upper_bound (m_cumulativeBytes.begin (), m_cumulativeBytes.end (), rest) - m_cumulativeBytes.begin () - 1;
+  bin = std::min (bin, m_binBytes.size () - 1);
+  double inBin = (rest - m_cumulativeBytes[bin]) / m_binBytes[bin] * m_binSize;
+  return (lap + laps) * duration + (int64_t) bin * m_binSize + (int64_t) ceil (inBin);
+}
+
+AbrTraceSession::AbrTraceSession (Ptr<const videoData> videoData, std::string algorithm, Ptr<const ThroughputTrace> trace,
+                                  int64_t traceOffset, int64_t requestDelay)
+  : m_trace (trace),
+    m_traceOffset (traceOffset),
+    m_requestDelay (requestDelay),
+    m_playedBitrateSum (0.0),
+    m_underrunStart (0)
+{
+  m_videoData = videoData;
+  CreateAlgorithm (algorithm);
+
+  m_metrics.averageBitrate = 0;
+  m_metrics.numberOfSwitches = 0;
+  m_metrics.numberOfStalls = 0;
+  m_metrics.stallDuration = 0;
+  m_metrics.startupDelay = 0;
+  m_metrics.sessionDuration = 0;
+}
+
+bool
+AbrTraceSession::Run (abrSessionMetrics &metrics)
+{
+  if (algo == NULL)
+    {
+      return false;
+    }
+  Simulator::ScheduleNow (&AbrTraceSession::Controller, this, init);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  if (m_currentPlaybackIndex > 0)
+    {
+      m_metrics.averageBitrate = m_playedBitrateSum / m_currentPlaybackIndex;
+    }
+  metrics = m_metrics;
+  return true;
+}
+
+void
+AbrTraceSession::Send (void)
+{
+  m_downloadRequestSent = Simulator::Now ().GetMicroSeconds ();
+  m_transmissionStartReceivingSegment = m_downloadRequestSent + m_requestDelay;
+  int64_t transmissionEnd = m_trace->GetTransferEnd (m_traceOffset + m_transmissionStartReceivingSegment,
+                                                     m_videoData->GetSegmentSize (m_currentRepIndex, m_segmentCounter))
+    - m_traceOffset;
+  Simulator::Schedule (MicroSeconds (transmissionEnd - m_downloadRequestSent), &AbrTraceSession::SegmentReceivedHandle, this);
+}
+
+void
+AbrTraceSession::SegmentReceivedHandle (void)
+{
+  m_transmissionEndReceivingSegment = Simulator::Now ().GetMicroSeconds ();
+  SegmentReceived ();
+}
+
+void
+AbrTraceSession::NotifyPlayback (int64_t timeNow)
+{
+  if (m_currentPlaybackIndex == 0)
+    {
+      m_metrics.startupDelay = timeNow;
+    }
+  else if (m_playbackData.playbackIndex.at (m_currentPlaybackIndex) != m_playbackData.playbackIndex.at (m_currentPlaybackIndex - 1))
+    {
+      m_metrics.numberOfSwitches++;
+    }
+  m_playedBitrateSum += m_videoData->averageBitrate.at (m_playbackData.playbackIndex.at (m_currentPlaybackIndex));
+}
+
+void
+AbrTraceSession::NotifyBufferUnderrunStart (int64_t timeNow)
+{
+  m_underrunStart = timeNow;
+  m_metrics.numberOfStalls++;
+}
+
+void
+AbrTraceSession::NotifyBufferUnderrunEnd (int64_t timeNow)
+{
+  m_metrics.stallDuration += timeNow - m_underrunStart;
+}
+
+void
+AbrTraceSession::NotifyTerminal (void)
+{
+  m_metrics.sessionDuration = Simulator::Now ().GetMicroSeconds () + m_videoData->segmentDuration;
+}
+
+} // namespace ns3
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ABR_TRACE_EVALUATOR_H
+#define ABR_TRACE_EVALUATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "tcp-stream-controller.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Link capacity over time, replayed from a recorded throughput trace.
+ *
+ * The capacity is piecewise constant over time bins of equal duration. Bins in which nothing was
+ * received, e.g. because the recording client was idle, take the capacity of the preceding bin.
+ * The trace repeats itself after its end. All points in time are given in microseconds.
+ */
+class ThroughputTrace : public SimpleRefCount<ThroughputTrace>
+{
+public:
+  /**
+   * \param binSize duration of a time bin in microseconds
+   * \param binBytes number of bytes received in every time bin, at least one of them non-zero
+   */
+  ThroughputTrace (int64_t binSize, const std::vector<int64_t> &binBytes);
+
+  /**
+   * \brief Read a throughput log file written by TcpStreamClient.
+   *
+   * Every line holds a point in time in seconds and a number of bytes received, as in the throughputLog.txt
+   * files with ThroughputSampling Packet or Bin. Lines that can't be parsed, like the header line, are skipped.
+   * With ThroughputSampling Segment, all bytes of a segment are logged at the end of its download and
+   * would end up in a single bin, so use ReadDownloadLog () for such sessions.
+   *
+   * \param path the path of the throughput log file
+   * \param binSize duration of a time bin in microseconds
+   * \return the trace, or 0 if the file can't be read or contains no bytes
+   */
+  static Ptr<ThroughputTrace> ReadThroughputLog (std::string path, int64_t binSize);
+
+  /**
+   * \brief Read a download log file written by TcpStreamClient.
+   *
+   * Every line of the downloadLog.txt files holds a segment index, the points in time in seconds when the
+   * segment was requested, started and finished and the segment size. The bytes of every segment are spread
+   * evenly over the time from its request until the end of its download. Lines that can't be parsed, like
+   * the header line, are skipped.
+   *
+   * \param path the path of the download log file
+   * \param binSize duration of a time bin in microseconds
+   * \return the trace, or 0 if the file can't be read or contains no bytes
+   */
+  static Ptr<ThroughputTrace> ReadDownloadLog (std::string path, int64_t binSize);
+
+  /**
+   * \return the duration of the trace in microseconds, after which it repeats itself
+   */
+  int64_t GetDuration (void) const;
+
+  /**
+   * \param start point in time when the transfer starts, may lie beyond the end of the trace
+   * \param bytes number of bytes to transfer
+   * \return the point in time when the transfer of bytes starting at start has finished
+   */
+  int64_t GetTransferEnd (int64_t start, int64_t bytes) const;
+
+private:
+  /**
+   * \return the number of bytes transferred from the start of the trace until offset, with offset < GetDuration ()
+   */
+  double GetBytesUntil (int64_t offset) const;
+
+  int64_t m_binSize; //!< duration of a time bin in microseconds
+  std::vector<double> m_binBytes; //!< capacity of every time bin in bytes
+  std::vector<double> m_cumulativeBytes; //!< bytes transferred from the start of the trace until the start of every bin, plus the total
+};
+
+/*! \class abrSessionMetrics abr-trace-evaluator.h "model/abr-trace-evaluator.h"
+ *  \ingroup tcpStream
+ *  \brief Quality of experience metrics of a streaming session.
+ */
+struct abrSessionMetrics
+{
+  double averageBitrate; //!< average bit rate of the played segments in bits per second
+  int64_t numberOfSwitches; //!< number of representation switches between consecutively played segments
+  int64_t numberOfStalls; //!< number of buffer underruns
+  int64_t stallDuration; //!< total duration of all buffer underruns in microseconds
+  int64_t startupDelay; //!< time from the start of the session until the start of playback in microseconds
+  int64_t sessionDuration; //!< time from the start of the session until the end of playback in microseconds
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief A streaming session driven by a throughput trace instead of the network stack.
+ *
+ * The session runs the controller state machine of TcpStreamClient, see TcpStreamController, but every
+ * segment download takes the time the link needs to deliver the segment according to a ThroughputTrace.
+ * The adaptation algorithm sees the same throughput, buffer and playback history as in a full simulation,
+ * with the simulator providing the virtual clock. As only a handful of events are scheduled per segment,
+ * thousands of sessions can be evaluated per second.
+ */
+class AbrTraceSession : public TcpStreamController
+{
+public:
+  /**
+   * \param videoData the segment sizes of the streamed video
+   * \param algorithm the name of the adaptation algorithm, "tobasco", "panda" or "festive"
+   * \param trace the throughput trace the downloads follow
+   * \param traceOffset point in time of the trace in microseconds at which the session starts
+   * \param requestDelay time in microseconds from sending a request until the first byte of the segment arrives
+   */
+  AbrTraceSession (Ptr<const videoData> videoData, std::string algorithm, Ptr<const ThroughputTrace> trace,
+                   int64_t traceOffset, int64_t requestDelay);
+
+  /**
+   * \brief Stream the whole video.
+   *
+   * The simulator runs until the session has finished and is destroyed afterwards, so no other
+   * simulation may be set up while a session runs.
+   *
+   * \param metrics the quality of experience metrics of the session
+   * \return false if the adaptation algorithm is unknown
+   */
+  bool Run (abrSessionMetrics &metrics);
+
+private:
+  /**
+   * \brief Request the current segment and schedule the end of its download.
+   */
+  virtual void Send (void);
+  /**
+   * \brief Hand the finished download to TcpStreamController::SegmentReceived ().
+   */
+  void SegmentReceivedHandle (void);
+  /**
+   * \brief Count the startup delay, representation switches and the played bit rate.
+   */
+  virtual void NotifyPlayback (int64_t timeNow);
+  virtual void NotifyBufferUnderrunStart (int64_t timeNow);
+  virtual void NotifyBufferUnderrunEnd (int64_t timeNow);
+  virtual void NotifyTerminal (void);
+
+  Ptr<const ThroughputTrace> m_trace; //!< the throughput trace the downloads follow
+  int64_t m_traceOffset; //!< point in time of the trace at which the session starts
+  int64_t m_requestDelay; //!< time from sending a request until the first byte arrives
+
+  abrSessionMetrics m_metrics; //!< metrics collected during the session
+  double m_playedBitrateSum; //!< sum of the bit rates of the played segments
+  int64_t m_underrunStart; //!< point in time when the current buffer underrun started
+};
+
+} // namespace ns3
+
+#endif /* ABR_TRACE_EVALUATOR_H */
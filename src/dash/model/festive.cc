@@ -41,6 +41,13 @@ FestiveAlgorithm::FestiveAlgorithm (  const videoData &videoData,
   NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be => 0");
 }
 
+size_t
+FestiveAlgorithm::GetHistoryDepth (void) const
+{
+  // the throughput estimation is the harmonic mean of the last 20 downloads
+  return 20;
+}
+
 algorithmReply
 FestiveAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 {
@@ -69,7 +76,8 @@ FestiveAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 
   // compute throughput estimation
   std::vector<double> thrptEstimationTmp;
-  for (unsigned sd = m_playbackData.playbackIndex.size (); sd-- > 0; )
+  // with a bounded history, only the retained entries are considered
+  for (unsigned sd = m_playbackData.playbackIndex.size (); sd-- > m_throughput.bytesReceived.GetFirstIndex (); )
     {
       if (m_throughput.bytesReceived.at (sd) == 0)
         {
@@ -122,7 +130,7 @@ FestiveAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
   if (currentRepIndex < m_highestRepIndex && !decisionMade)
     {
       int count = 0;
-      for (unsigned _sd = m_playbackData.playbackIndex.size () - 1; _sd-- > 0; )
+      for (unsigned _sd = m_playbackData.playbackIndex.size () - 1; _sd-- > m_playbackData.playbackIndex.GetFirstIndex (); )
         {
           if (currentRepIndex == m_playbackData.playbackIndex.at (_sd))
             {
@@ -157,7 +165,9 @@ FestiveAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
   // compute number of bit rate switches in the last 20 seconds
   int64_t numberOfSwitches = 0;
   std::vector<int64_t> foundIndices;
-  for (unsigned _sd = m_playbackData.playbackStart.size () - 1; _sd-- > 0; )
+  size_t firstPlaybackIndex = std::max (m_playbackData.playbackStart.GetFirstIndex (),
+                                       m_playbackData.playbackIndex.GetFirstIndex ());
+  for (unsigned _sd = m_playbackData.playbackStart.size () - 1; _sd-- > firstPlaybackIndex; )
     {
       if (m_playbackData.playbackStart.at (_sd) < timeNow)
         {
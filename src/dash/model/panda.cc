@@ -42,6 +42,13 @@ PandaAlgorithm::PandaAlgorithm (  const videoData &videoData,
   NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be => 0");
 }
 
+size_t
+PandaAlgorithm::GetHistoryDepth (void) const
+{
+  // only the last download
+  return 1;
+}
+
 algorithmReply
 PandaAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 {
@@ -35,6 +35,8 @@ public:
                     const bufferData & bufferData,
                     const throughputData & throughput);
 
+  size_t GetHistoryDepth (void) const;
+
   algorithmReply GetNextRep (const int64_t segmentCounter, int64_t clientId);
 
 private:
@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "segment-size-manifest.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentSizeManifest");
+
+namespace {
+
+char const binaryMagic[8] = { 'D', 'A', 'S', 'H', 'S', 'S', 'Z', '1' };
+
+/**
+ * Header of the binary segment size format, followed by the packed segment sizes.
+ */
+struct BinaryHeader
+{
+  char magic[8];
+  uint32_t numberOfRepresentations;
+  uint32_t numberOfSegments;
+  int64_t segmentDuration;
+};
+
+/**
+ * Manifest of a binary segment size file, whose segment sizes are read from the file mapping.
+ * The file stays mapped until the last client releases the manifest.
+ */
+struct MappedVideoData : public videoData
+{
+  MappedVideoData (void *mapping, size_t length)
+    : m_mapping (mapping),
+      m_length (length)
+  {
+    mappedSegmentSize = reinterpret_cast<const uint32_t *> (static_cast<const char *> (mapping) + sizeof (BinaryHeader));
+  }
+
+  virtual ~MappedVideoData ()
+  {
+    munmap (m_mapping, m_length);
+  }
+
+  void *m_mapping; //!< start of the mapped file
+  size_t m_length; //!< length of the mapped file in bytes
+};
+
+} // anonymous namespace
+
+SegmentSizeManifest::ManifestMap &
+SegmentSizeManifest::GetRegistry ()
+{
+  static ManifestMap registry;
+  return registry;
+}
+
+Ptr<const videoData>
+SegmentSizeManifest::Get (std::string segmentSizeFile, int64_t segmentDuration)
+{
+  NS_LOG_FUNCTION (segmentSizeFile << segmentDuration);
+  ManifestMap &registry = GetRegistry ();
+  std::pair<std::string, int64_t> key (segmentSizeFile, segmentDuration);
+  ManifestMap::const_iterator it = registry.find (key);
+  if (it != registry.end ())
+    {
+      return it->second;
+    }
+
+  Ptr<const videoData> manifest;
+  if (IsBinaryFile (segmentSizeFile))
+    {
+      manifest = ReadBinaryFile (segmentSizeFile, segmentDuration);
+    }
+  else
+    {
+      manifest = ReadTextFile (segmentSizeFile, segmentDuration);
+    }
+  if (manifest != 0)
+    {
+      registry[key] = manifest;
+    }
+  return manifest;
+}
+
+void
+SegmentSizeManifest::Clear ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetRegistry ().clear ();
+}
+
+Ptr<videoData>
+SegmentSizeManifest::ReadTextFile (std::string segmentSizeFile, int64_t segmentDuration)
+{
+  NS_LOG_FUNCTION (segmentSizeFile << segmentDuration);
+  std::ifstream myfile;
+  myfile.open (segmentSizeFile.c_str ());
+  if (!myfile)
+    {
+      return 0;
+    }
+  Ptr<videoData> manifest = Create<videoData> ();
+  manifest->segmentDuration = segmentDuration;
+  manifest->numberOfSegments = 0;
+  std::string temp;
+  while (std::getline (myfile, temp))
+    {
+      if (temp.empty ())
+        {
+          break;
+        }
+      std::istringstream buffer (temp);
+      std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
+                                 std::istream_iterator<int64_t>());
+      if (manifest->averageBitrate.empty ())
+        {
+          manifest->numberOfSegments = line.size ();
+        }
+      if ((int64_t) line.size () != manifest->numberOfSegments)
+        {
+          NS_LOG_ERROR ("Representation level " << manifest->averageBitrate.size () << " in " << segmentSizeFile
+                                                << " contains " << line.size () << " instead of "
+                                                << manifest->numberOfSegments << " segment sizes.");
+          return 0;
+        }
+      manifest->segmentSize.insert (manifest->segmentSize.end (), line.begin (), line.end ());
+      manifest->averageBitrate.push_back (0);
+    }
+  if (manifest->segmentSize.empty ())
+    {
+      NS_LOG_ERROR ("No segment sizes read from " << segmentSizeFile << ".");
+      return 0;
+    }
+  ComputeAverageBitrates (manifest);
+  return manifest;
+}
+
+bool
+SegmentSizeManifest::IsBinaryFile (std::string segmentSizeFile)
+{
+  std::ifstream myfile (segmentSizeFile.c_str (), std::ios::binary);
+  char magic[sizeof (binaryMagic)];
+  if (!myfile.read (magic, sizeof (magic)))
+    {
+      return false;
+    }
+  return std::memcmp (magic, binaryMagic, sizeof (binaryMagic)) == 0;
+}
+
+Ptr<videoData>
+SegmentSizeManifest::ReadBinaryFile (std::string segmentSizeFile, int64_t segmentDuration)
+{
+  NS_LOG_FUNCTION (segmentSizeFile << segmentDuration);
+  int fd = open (segmentSizeFile.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return 0;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size < (off_t) sizeof (BinaryHeader))
+    {
+      close (fd);
+      return 0;
+    }
+  BinaryHeader header;
+  if (pread (fd, &header, sizeof (header), 0) != (ssize_t) sizeof (header))
+    {
+      close (fd);
+      return 0;
+    }
+  if (header.numberOfRepresentations == 0 || header.numberOfSegments == 0)
+    {
+      NS_LOG_ERROR ("Binary segment size file " << segmentSizeFile << " contains no segments.");
+      close (fd);
+      return 0;
+    }
+  // the header fields are untrusted, the sizes they announce must be in the file
+  uint64_t numberOfSizes = (uint64_t) header.numberOfRepresentations * header.numberOfSegments;
+  if ((uint64_t) st.st_size < sizeof (BinaryHeader) + numberOfSizes * sizeof (uint32_t))
+    {
+      NS_LOG_ERROR ("Binary segment size file " << segmentSizeFile << " is truncated.");
+      close (fd);
+      return 0;
+    }
+  if (header.segmentDuration != 0 && header.segmentDuration != segmentDuration)
+    {
+      close (fd);
+      NS_FATAL_ERROR ("Segment duration " << header.segmentDuration << " stored in " << segmentSizeFile
+                                          << " differs from the configured segment duration " << segmentDuration);
+    }
+
+  void *mapping = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    {
+      NS_LOG_ERROR ("Mapping binary segment size file " << segmentSizeFile << " failed.");
+      return 0;
+    }
+
+  // the segment sizes are not copied, they are read from the mapping as long as the manifest is in use
+  Ptr<videoData> manifest = Create<MappedVideoData> (mapping, st.st_size);
+  manifest->segmentDuration = segmentDuration;
+  manifest->numberOfSegments = header.numberOfSegments;
+  manifest->averageBitrate.resize (header.numberOfRepresentations);
+  ComputeAverageBitrates (manifest);
+  return manifest;
+}
+
+bool
+SegmentSizeManifest::WriteBinaryFile (Ptr<const videoData> manifest, std::string binaryFile)
+{
+  NS_LOG_FUNCTION (binaryFile);
+  std::ofstream out (binaryFile.c_str (), std::ios::binary | std::ios::trunc);
+  if (!out)
+    {
+      return false;
+    }
+  BinaryHeader header;
+  std::memcpy (header.magic, binaryMagic, sizeof (binaryMagic));
+  header.numberOfRepresentations = manifest->averageBitrate.size ();
+  header.numberOfSegments = manifest->numberOfSegments;
+  header.segmentDuration = manifest->segmentDuration;
+  out.write (reinterpret_cast<const char *> (&header), sizeof (header));
+
+  std::vector<uint32_t> sizes;
+  sizes.reserve (manifest->averageBitrate.size () * manifest->numberOfSegments);
+  for (size_t i = 0; i < manifest->averageBitrate.size (); i++)
+    {
+      for (int64_t j = 0; j < manifest->numberOfSegments; j++)
+        {
+          NS_ASSERT_MSG (manifest->GetSegmentSize (i, j) <= UINT32_MAX,
+                         "Segment sizes must fit into 32 bits for the binary segment size format.");
+          sizes.push_back (manifest->GetSegmentSize (i, j));
+        }
+    }
+  out.write (reinterpret_cast<const char *> (&sizes[0]), sizes.size () * sizeof (uint32_t));
+  return out.good ();
+}
+
+void
+SegmentSizeManifest::ComputeAverageBitrates (Ptr<videoData> manifest)
+{
+  int64_t averageByteSizeTemp = 0;
+  for (size_t i = 0; i < manifest->averageBitrate.size (); i++)
+    {
+      double sum = 0.0;
+      for (int64_t j = 0; j < manifest->numberOfSegments; j++)
+        {
+          sum += manifest->GetSegmentSize (i, j);
+        }
+      averageByteSizeTemp = (int64_t) sum / manifest->numberOfSegments;
+      manifest->averageBitrate.at (i) = (8.0 * averageByteSizeTemp) / (manifest->segmentDuration / 1000000.0);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SEGMENT_SIZE_MANIFEST_H
+#define SEGMENT_SIZE_MANIFEST_H
+
+#include <map>
+#include <string>
+#include "ns3/ptr.h"
+#include "tcp-stream-interface.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Process-wide registry of read-only segment size manifests.
+ *
+ * Every segment size file is read in only once per segment duration. All clients asking for the same
+ * file share the resulting videoData object through reference counting, instead of every client
+ * holding its own copy of the (n x m) segment size matrix.
+ *
+ * Two file formats are accepted: the text matrix described in the module README, and a compact binary
+ * format which is memory-mapped instead of being parsed; its segment sizes are read from the mapping.
+ * A binary file starts with the following header, all fields in host byte order:
+ *
+ * - 8 bytes magic "DASHSSZ1"
+ * - uint32_t number of representation levels n
+ * - uint32_t number of segments m
+ * - int64_t duration of a segment in microseconds
+ *
+ * followed by n x m uint32_t segment sizes in bytes, in representation-major order.
+ * WriteBinaryFile () converts a loaded manifest into this format.
+ */
+class SegmentSizeManifest
+{
+public:
+  /**
+   * \brief Get the manifest for a segment size file, reading it in on first use.
+   *
+   * \param segmentSizeFile the relative path (from ns-3.x directory) to the file containing the segment sizes in bytes
+   * \param segmentDuration the duration of a segment in microseconds, used for computing the average bitrates
+   * \return the shared manifest, or 0 if the file could not be read
+   */
+  static Ptr<const videoData> Get (std::string segmentSizeFile, int64_t segmentDuration);
+
+  /**
+   * \brief Drop the registry's references to all manifests.
+   *
+   * Manifests still in use by clients stay alive until the last client releases them.
+   */
+  static void Clear ();
+
+  /**
+   * \brief Write a manifest to a file in the binary segment size format.
+   *
+   * \param manifest the manifest to write
+   * \param binaryFile the path of the file to write
+   * \return true if the file was written successfully
+   */
+  static bool WriteBinaryFile (Ptr<const videoData> manifest, std::string binaryFile);
+
+private:
+  /**
+   * \brief Read in the segment size matrix from a text file.
+   *
+   * The segment sizes must be provided in bytes in absolute sizes (not per second!) as a (n x m) matrix,
+   * with spaces separating the segment sizes and newlines for every representation level.
+   *
+   * \return the manifest, or 0 if the file could not be opened, contains no segment sizes or
+   *         representation levels with different numbers of segments
+   */
+  static Ptr<videoData> ReadTextFile (std::string segmentSizeFile, int64_t segmentDuration);
+
+  /**
+   * \brief Map a binary file, the manifest reads the segment sizes from the mapping while it is in use.
+   *
+   * A segment duration stored in the file header must match segmentDuration, otherwise the simulation
+   * is aborted. A header containing 0 leaves the segment duration to the configuration.
+   *
+   * \return the manifest, or 0 if the file could not be mapped, is truncated or contains no segments
+   */
+  static Ptr<videoData> ReadBinaryFile (std::string segmentSizeFile, int64_t segmentDuration);
+
+  /**
+   * \return true if the file starts with the magic of the binary segment size format
+   */
+  static bool IsBinaryFile (std::string segmentSizeFile);
+
+  /**
+   * \brief Compute the average bitrate of every representation level from the segment sizes.
+   */
+  static void ComputeAverageBitrates (Ptr<videoData> manifest);
+
+  typedef std::map<std::pair<std::string, int64_t>, Ptr<const videoData> > ManifestMap;
+  static ManifestMap & GetRegistry ();
+};
+
+} // namespace ns3
+
+#endif /* SEGMENT_SIZE_MANIFEST_H */
@@ -34,4 +34,15 @@ AdaptationAlgorithm::AdaptationAlgorithm (  const videoData & videoData,
 {
 }
 
+void
+AdaptationAlgorithm::SegmentReceived (const int64_t segmentCounter)
+{
+}
+
+size_t
+AdaptationAlgorithm::GetHistoryDepth (void) const
+{
+  return 0;
+}
+
 } // namespace ns3
\ No newline at end of file
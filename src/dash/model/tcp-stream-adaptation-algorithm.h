@@ -56,6 +56,29 @@ public:
    */
   virtual algorithmReply GetNextRep ( const int64_t segmentCounter, int64_t clientId) = 0;
 
+  /**
+   * \ingroup tcpStream
+   * \brief Notify the algorithm that the download of a segment is complete
+   *
+   * Called by the client after the throughput and buffer data of the segment have been recorded.
+   * Algorithms keeping incremental state, e.g. a ThroughputEstimator, update it here instead of
+   * scanning the whole history in GetNextRep. The default implementation does nothing.
+   *
+   * \param segmentCounter the index of the downloaded segment
+   */
+  virtual void SegmentReceived (const int64_t segmentCounter);
+
+  /**
+   * \ingroup tcpStream
+   * \brief Number of most recent entries of the throughput, buffer and playback history the algorithm accesses
+   *
+   * Clients running with a bounded history keep at least this many entries. The default implementation
+   * returns 0, meaning that the algorithm needs the whole history.
+   *
+   * \return the history depth the algorithm needs, 0 for the whole history
+   */
+  virtual size_t GetHistoryDepth (void) const;
+
 protected:
   const videoData & m_videoData;
   const bufferData & m_bufferData;
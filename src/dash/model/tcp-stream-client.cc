@@ -28,6 +28,10 @@
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
 #include "tcp-stream-client.h"
+#include "segment-size-manifest.h"
+#include "tcp-stream-log-sink.h"
+#include "tcp-stream-request-header.h"
+#include "ns3/enum.h"
 #include <math.h>
 #include <sstream>
 #include <stdexcept>
@@ -59,115 +63,6 @@ NS_LOG_COMPONENT_DEFINE ("TcpStreamClientApplication");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpStreamClient);
 
-void
-TcpStreamClient::Controller (controllerEvent event)
-{
-  NS_LOG_FUNCTION (this);
-  if (state == initial)
-    {
-      RequestRepIndex ();
-      state = downloading;
-      Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-      return;
-    }
-
-  if (state == downloading)
-    {
-      PlaybackHandle ();
-      if (m_currentPlaybackIndex <= m_lastSegmentIndex)
-        {
-          /*  e_d  */
-          m_segmentCounter++;
-          RequestRepIndex ();
-          state = downloadingPlaying;
-          Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-        }
-      else
-        {
-          /*  e_df  */
-          state = playing;
-        }
-      controllerEvent ev = playbackFinished;
-      // std::cerr << "Client " << m_clientId << " " << Simulator::Now ().GetSeconds () << "\n";
-      Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
-      return;
-    }
-
-
-  else if (state == downloadingPlaying)
-    {
-      if (event == downloadFinished)
-        {
-          if (m_segmentCounter < m_lastSegmentIndex)
-            {
-              m_segmentCounter++;
-              RequestRepIndex ();
-            }
-
-          if (m_bDelay > 0 && m_segmentCounter <= m_lastSegmentIndex)
-            {
-              /*  e_dirs */
-              state = playing;
-              controllerEvent ev = irdFinished;
-              Simulator::Schedule (MicroSeconds (m_bDelay), &TcpStreamClient::Controller, this, ev);
-            }
-          else if (m_segmentCounter == m_lastSegmentIndex)
-            {
-              /*  e_df  */
-              state = playing;
-            }
-          else
-            {
-              /*  e_d  */
-              Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-            }
-        }
-      else if (event == playbackFinished)
-        {
-          if (!PlaybackHandle ())
-            {
-              /*  e_pb  */
-              controllerEvent ev = playbackFinished;
-              // std::cerr << "FIRST CASE. Client " << m_clientId << " " << Simulator::Now ().GetSeconds () << "\n";
-              Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
-            }
-          else
-            {
-              /*  e_pu  */
-              state = downloading;
-            }
-        }
-      return;
-    }
-
-
-  else if (state == playing)
-    {
-      if (event == irdFinished)
-        {
-          /*  e_irc  */
-          state = downloadingPlaying;
-          Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-        }
-      else if (event == playbackFinished && m_currentPlaybackIndex < m_lastSegmentIndex)
-        {
-          /*  e_pb  */
-          // std::cerr << "SECOND CASE. Client " << m_clientId << " " << Simulator::Now ().GetSeconds () << "\n";
-          PlaybackHandle ();
-          controllerEvent ev = playbackFinished;
-          Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
-        }
-      else if (event == playbackFinished && m_currentPlaybackIndex == m_lastSegmentIndex)
-        {
-          PlaybackHandle ();
-          /*  e_pf  */
-          state = terminal;
-          StopApplication ();
-        }
-      return;
-    }
-}
-
 TypeId
 TcpStreamClient::GetTypeId (void)
 {
@@ -191,7 +86,7 @@ TcpStreamClient::GetTypeId (void)
                    MakeUintegerAccessor (&TcpStreamClient::m_segmentDuration),
                    MakeUintegerChecker<uint64_t> ())
     .AddAttribute ("SegmentSizeFilePath",
-                   "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes",
+                   "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes, either as text matrix or in the binary segment size format",
                    StringValue ("bitrates.txt"),
                    MakeStringAccessor (&TcpStreamClient::m_segmentSizeFilePath),
                    MakeStringChecker ())
@@ -210,6 +105,30 @@ TcpStreamClient::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&TcpStreamClient::m_clientId),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LogFormat",
+                   "Format of the log files: six text files per client, or one binary file shared by all clients of the simulation",
+                   EnumValue (TcpStreamClient::LOG_TEXT),
+                   MakeEnumAccessor (&TcpStreamClient::m_logFormat),
+                   MakeEnumChecker (TcpStreamClient::LOG_TEXT, "Text",
+                                    TcpStreamClient::LOG_BINARY, "Binary"))
+    .AddAttribute ("ThroughputSampling",
+                   "Granularity of the throughput log: one record per received packet, per time bin of ThroughputBinSize or per segment",
+                   EnumValue (TcpStreamClient::THROUGHPUT_PACKET),
+                   MakeEnumAccessor (&TcpStreamClient::m_throughputSampling),
+                   MakeEnumChecker (TcpStreamClient::THROUGHPUT_PACKET, "Packet",
+                                    TcpStreamClient::THROUGHPUT_BIN, "Bin",
+                                    TcpStreamClient::THROUGHPUT_SEGMENT, "Segment"))
+    .AddAttribute ("ThroughputBinSize",
+                   "The duration of a time bin of the throughput log, if ThroughputSampling is Bin",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&TcpStreamClient::m_throughputBinSize),
+                   MakeTimeChecker (MicroSeconds (1)))
+    .AddAttribute ("HistoryDepth",
+                   "Number of most recent entries kept of the throughput, buffer and playback history, 0 for keeping the whole history. "
+                   "Raised to the depth the adaptation algorithm needs",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpStreamClient::m_historyDepth),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -218,17 +137,10 @@ TcpStreamClient::TcpStreamClient ()
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
-  m_data = 0;
-  m_dataSize = 0;
-  state = initial;
 
-  m_currentRepIndex = 0;
-  m_segmentCounter = 0;
-  m_bDelay = 0;
   m_bytesReceived = 0;
-  m_segmentsInBuffer = 0;
-  m_bufferUnderrun = false;
-  m_currentPlaybackIndex = 0;
+  m_throughputBinStart = 0;
+  m_throughputBinBytes = 0;
 
 }
 
@@ -236,28 +148,15 @@ void
 TcpStreamClient::Initialise (std::string algorithm, uint16_t clientId)
 {
   NS_LOG_FUNCTION (this);
-  m_videoData.segmentDuration = m_segmentDuration;
-  if (ReadInBitrateValues (ToString (m_segmentSizeFilePath)) == -1)
+  m_videoData = SegmentSizeManifest::Get (m_segmentSizeFilePath, m_segmentDuration);
+  if (m_videoData == 0)
     {
       NS_LOG_ERROR ("Opening test bitrate file failed. Terminating.\n");
       Simulator::Stop ();
       Simulator::Destroy ();
+      return;
     }
-  m_lastSegmentIndex = (int64_t) m_videoData.segmentSize.at (0).size () - 1;
-  m_highestRepIndex = m_videoData.averageBitrate.size () - 1;
-  if (algorithm == "tobasco")
-    {
-      algo = new TobascoAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput);
-    }
-  else if (algorithm == "panda")
-    {
-      algo = new PandaAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput);
-    }
-  else if (algorithm == "festive")
-    {
-      algo = new FestiveAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput);
-    }
-  else
+  if (!CreateAlgorithm (algorithm))
     {
       NS_LOG_ERROR ("Invalid algorithm name entered. Terminating.");
       StopApplication ();
@@ -265,6 +164,15 @@ TcpStreamClient::Initialise (std::string algorithm, uint16_t clientId)
       Simulator::Destroy ();
     }
 
+  // bound the history only if the algorithm does not need all of it
+  if (m_historyDepth > 0 && algo != NULL && algo->GetHistoryDepth () > 0)
+    {
+      size_t depth = std::max ((size_t) m_historyDepth, algo->GetHistoryDepth ());
+      m_throughput.SetHistoryDepth (depth);
+      m_bufferData.SetHistoryDepth (depth);
+      m_playbackData.SetHistoryDepth (depth);
+    }
+
   m_algoName = algorithm;
 
   InitializeLogFiles (ToString (m_simulationId), ToString (m_clientId), ToString (m_numberOfClients));
@@ -275,38 +183,18 @@ TcpStreamClient::~TcpStreamClient ()
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
-
-  delete algo;
-  algo = NULL;
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
 }
 
 void
-TcpStreamClient::RequestRepIndex ()
+TcpStreamClient::Send ()
 {
   NS_LOG_FUNCTION (this);
-  algorithmReply answer;
-
-  answer = algo->GetNextRep ( m_segmentCounter, m_clientId );
-  m_currentRepIndex = answer.nextRepIndex;
-  NS_ASSERT_MSG (answer.nextRepIndex <= m_highestRepIndex, "The algorithm returned a representation index that's higher than the maximum");
-
-  m_playbackData.playbackIndex.push_back (answer.nextRepIndex);
-  m_bDelay = answer.nextDownloadDelay;
-  // std::cerr << m_segmentCounter << "\n";
-  LogAdaptation (answer);
-}
-
-template <typename T>
-void
-TcpStreamClient::Send (T & message)
-{
-  NS_LOG_FUNCTION (this);
-  PreparePacket (message);
-  Ptr<Packet> p;
-  p = Create<Packet> (m_data, m_dataSize);
+  TcpStreamRequestHeader request;
+  request.SetSegmentIndex (m_segmentCounter);
+  request.SetRepIndex (m_currentRepIndex);
+  request.SetSegmentSize (m_videoData->GetSegmentSize (m_currentRepIndex, m_segmentCounter));
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (request);
   m_downloadRequestSent = Simulator::Now ().GetMicroSeconds ();
   m_socket->Send (p);
 }
@@ -324,42 +212,20 @@ TcpStreamClient::HandleRead (Ptr<Socket> socket)
   while ( (packet = socket->Recv ()) )
     {
       packetSize = packet->GetSize ();
-      LogThroughput (packetSize);
-      m_bytesReceived += packetSize;
-      if (m_bytesReceived == m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter))
+      if (m_throughputSampling == THROUGHPUT_PACKET)
         {
-          SegmentReceivedHandle ();
+          LogThroughput (packetSize);
         }
-    }
-}
-
-int
-TcpStreamClient::ReadInBitrateValues (std::string segmentSizeFile)
-{
-  NS_LOG_FUNCTION (this);
-  std::ifstream myfile;
-  myfile.open (segmentSizeFile.c_str ());
-  if (!myfile)
-    {
-      return -1;
-    }
-  std::string temp;
-  int64_t averageByteSizeTemp = 0;
-  while (std::getline (myfile, temp))
-    {
-      if (temp.empty ())
+      else if (m_throughputSampling == THROUGHPUT_BIN)
+        {
+          SampleThroughput (packetSize);
+        }
+      m_bytesReceived += packetSize;
+      if (m_bytesReceived == m_videoData->GetSegmentSize (m_currentRepIndex, m_segmentCounter))
         {
-          break;
+          SegmentReceivedHandle ();
         }
-      std::istringstream buffer (temp);
-      std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
-                                 std::istream_iterator<int64_t>());
-      m_videoData.segmentSize.push_back (line);
-      averageByteSizeTemp = (int64_t) std::accumulate ( line.begin (), line.end (), 0.0) / line.size ();
-      m_videoData.averageBitrate.push_back ((8.0 * averageByteSizeTemp) / (m_videoData.segmentDuration / 1000000.0));
     }
-  NS_ASSERT_MSG (!m_videoData.segmentSize.empty (), "No segment sizes read from file.");
-  return 1;
 }
 
 void
@@ -367,70 +233,57 @@ TcpStreamClient::SegmentReceivedHandle ()
 {
   NS_LOG_FUNCTION (this);
   m_transmissionEndReceivingSegment = Simulator::Now ().GetMicroSeconds ();
+  m_bytesReceived = 0;
+  SegmentReceived ();
+}
 
+int64_t
+TcpStreamClient::GetAlgorithmClientId () const
+{
+  return m_clientId;
+}
 
-  m_bufferData.timeNow.push_back (m_transmissionEndReceivingSegment);
-  if (m_segmentCounter > 0)
-    { //if a buffer underrun is encountered, the old buffer level will be set to 0, because the buffer can not be negative
-      m_bufferData.bufferLevelOld.push_back (std::max (m_bufferData.bufferLevelNew.back () -
-                                                       (m_transmissionEndReceivingSegment - m_throughput.transmissionEnd.back ()), (int64_t)0));
-    }
-  else //first segment
-    {
-      m_bufferData.bufferLevelOld.push_back (0);
-    }
-  m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelOld.back () + m_videoData.segmentDuration);
-
-  m_throughput.bytesReceived.push_back (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-  m_throughput.transmissionStart.push_back (m_transmissionStartReceivingSegment);
-  m_throughput.transmissionRequested.push_back (m_downloadRequestSent);
-  m_throughput.transmissionEnd.push_back (m_transmissionEndReceivingSegment);
+void
+TcpStreamClient::NotifyRepIndex (const algorithmReply &answer)
+{
+  LogAdaptation (answer);
+}
 
+void
+TcpStreamClient::NotifySegmentReceived ()
+{
   LogDownload ();
 
   LogBuffer ();
 
-  m_segmentsInBuffer++;
-  m_bytesReceived = 0;
-  if (m_segmentCounter == m_lastSegmentIndex)
+  if (m_throughputSampling == THROUGHPUT_SEGMENT)
     {
-      m_bDelay = 0;
+      m_logSink->LogThroughput (m_clientId, m_transmissionEndReceivingSegment, m_throughput.bytesReceived.back ());
     }
+}
 
-  controllerEvent event = downloadFinished;
-  Controller (event);
+void
+TcpStreamClient::NotifyPlayback (int64_t timeNow)
+{
+  LogPlayback ();
+}
 
+void
+TcpStreamClient::NotifyBufferUnderrunStart (int64_t timeNow)
+{
+  m_logSink->LogBufferUnderrunStart (m_clientId, timeNow);
 }
 
-bool
-TcpStreamClient::PlaybackHandle ()
+void
+TcpStreamClient::NotifyBufferUnderrunEnd (int64_t timeNow)
 {
-  NS_LOG_FUNCTION (this);
-  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
-  // if we got called and there are no segments left in the buffer, there is a buffer underrun
-  if (m_segmentsInBuffer == 0 && m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun)
-    {
-      m_bufferUnderrun = true;
-      bufferUnderrunLog << std::setfill (' ') << std::setw (26) << timeNow / (double)1000000 << " ";
-      bufferUnderrunLog.flush ();
-      return true;
-    }
-  else if (m_segmentsInBuffer > 0)
-    {
-      if (m_bufferUnderrun)
-        {
-          m_bufferUnderrun = false;
-          bufferUnderrunLog << std::setfill (' ') << std::setw (13) << timeNow / (double)1000000 << "\n";
-          bufferUnderrunLog.flush ();
-        }
-      m_playbackData.playbackStart.push_back (timeNow);
-      LogPlayback ();
-      m_segmentsInBuffer--;
-      m_currentPlaybackIndex++;
-      return false;
-    }
+  m_logSink->LogBufferUnderrunEnd (m_clientId, timeNow);
+}
 
-  return true;
+void
+TcpStreamClient::NotifyTerminal ()
+{
+  StopApplication ();
 }
 
 void
@@ -461,6 +314,7 @@ void
 TcpStreamClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_logSink = 0;
   Application::DoDispose ();
 }
 
@@ -498,34 +352,18 @@ TcpStreamClient::StopApplication ()
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
       m_socket = 0;
     }
-  downloadLog.close ();
-  playbackLog.close ();
-  adaptationLog.close ();
-  bufferLog.close ();
-  throughputLog.close ();
-  bufferUnderrunLog.close ();
-}
-
-
-template <typename T>
-void
-TcpStreamClient::PreparePacket (T & message)
-{
-  NS_LOG_FUNCTION (this << message);
-  std::ostringstream ss;
-  ss << message;
-  ss.str ();
-  uint32_t dataSize = ss.str ().size () + 1;
-
-  if (dataSize != m_dataSize)
+  if (m_logSink != 0)
     {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
+      if (m_throughputBinBytes > 0)
+        {
+          m_logSink->LogThroughput (m_clientId, m_throughputBinStart, m_throughputBinBytes);
+          m_throughputBinBytes = 0;
+        }
+      m_logSink->Flush ();
     }
-  memcpy (m_data, ss.str ().c_str (), dataSize);
 }
 
+
 void
 TcpStreamClient::ConnectionSucceeded (Ptr<Socket> socket)
 {
@@ -542,95 +380,88 @@ TcpStreamClient::ConnectionFailed (Ptr<Socket> socket)
   NS_LOG_LOGIC ("Tcp Stream Client connection failed");
 }
 
+void
+TcpStreamClient::SetLogSink (Ptr<TcpStreamLogSink> sink)
+{
+  NS_LOG_FUNCTION (this);
+  m_logSink = sink;
+}
+
 void
 TcpStreamClient::LogThroughput (uint32_t packetSize)
 {
   NS_LOG_FUNCTION (this);
-  throughputLog << std::setfill (' ') << std::setw (13) << Simulator::Now ().GetMicroSeconds ()  / (double) 1000000 << " "
-                << std::setfill (' ') << std::setw (13) << packetSize << "\n";
-  throughputLog.flush ();
+  m_logSink->LogThroughput (m_clientId, Simulator::Now ().GetMicroSeconds (), packetSize);
+}
+
+void
+TcpStreamClient::SampleThroughput (uint32_t packetSize)
+{
+  NS_LOG_FUNCTION (this);
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  int64_t binSize = m_throughputBinSize.GetMicroSeconds ();
+  if (timeNow >= m_throughputBinStart + binSize)
+    {
+      if (m_throughputBinBytes > 0)
+        {
+          m_logSink->LogThroughput (m_clientId, m_throughputBinStart, m_throughputBinBytes);
+        }
+      m_throughputBinStart = timeNow - (timeNow % binSize);
+      m_throughputBinBytes = 0;
+    }
+  m_throughputBinBytes += packetSize;
 }
 
 void
 TcpStreamClient::LogDownload ()
 {
   NS_LOG_FUNCTION (this);
-  downloadLog << std::setfill (' ') << std::setw (13) << m_segmentCounter << " "
-              << std::setfill (' ') << std::setw (21) << m_downloadRequestSent / (double)1000000 << " "
-              << std::setfill (' ') << std::setw (14) << m_transmissionStartReceivingSegment / (double)1000000 << " "
-              << std::setfill (' ') << std::setw (12) << m_transmissionEndReceivingSegment / (double)1000000 << " "
-              << std::setfill (' ') << std::setw (12) << m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter) << " "
-              << std::setfill (' ') << std::setw (12) << "Y\n";
-  downloadLog.flush ();
+  m_logSink->LogDownload (m_clientId, m_segmentCounter, m_downloadRequestSent, m_transmissionStartReceivingSegment,
+                          m_transmissionEndReceivingSegment, m_videoData->GetSegmentSize (m_currentRepIndex, m_segmentCounter));
 }
 
 void
 TcpStreamClient::LogBuffer ()
 {
   NS_LOG_FUNCTION (this);
-  bufferLog << std::setfill (' ') << std::setw (13) << m_transmissionEndReceivingSegment / (double)1000000 << " "
-            << std::setfill (' ') << std::setw (13) << m_bufferData.bufferLevelOld.back () / (double)1000000 << "\n"
-            << std::setfill (' ') << std::setw (13) << m_transmissionEndReceivingSegment / (double)1000000 << " "
-            << std::setfill (' ') << std::setw (13) << m_bufferData.bufferLevelNew.back () / (double)1000000 << "\n";
-  bufferLog.flush ();
+  m_logSink->LogBuffer (m_clientId, m_transmissionEndReceivingSegment, m_bufferData.bufferLevelOld.back (),
+                        m_bufferData.bufferLevelNew.back ());
 }
 
 void
 TcpStreamClient::LogAdaptation (algorithmReply answer)
 {
   NS_LOG_FUNCTION (this);
-  adaptationLog << std::setfill (' ') << std::setw (13) << m_segmentCounter << " "
-                << std::setfill (' ') << std::setw (9) << m_currentRepIndex << " "
-                << std::setfill (' ') << std::setw (22) << answer.decisionTime / (double)1000000 << " "
-                << std::setfill (' ') << std::setw (4) << answer.decisionCase << " "
-                << std::setfill (' ') << std::setw (9) << answer.delayDecisionCase << "\n";
-  adaptationLog.flush ();
+  m_logSink->LogAdaptation (m_clientId, m_segmentCounter, m_currentRepIndex, answer.decisionTime,
+                            answer.decisionCase, answer.delayDecisionCase);
 }
 
 void
 TcpStreamClient::LogPlayback ()
 {
   NS_LOG_FUNCTION (this);
-  playbackLog << std::setfill (' ') << std::setw (13) << m_currentPlaybackIndex << " "
-              << std::setfill (' ') << std::setw (14) << Simulator::Now ().GetMicroSeconds ()  / (double)1000000 << " "
-              << std::setfill (' ') << std::setw (13) << m_playbackData.playbackIndex.at (m_currentPlaybackIndex) << "\n";
-  playbackLog.flush ();
+  m_logSink->LogPlayback (m_clientId, m_currentPlaybackIndex, Simulator::Now ().GetMicroSeconds (),
+                          m_playbackData.playbackIndex.at (m_currentPlaybackIndex));
 }
 
 void
 TcpStreamClient::InitializeLogFiles (std::string simulationId, std::string clientId, std::string numberOfClients)
 {
   NS_LOG_FUNCTION (this);
+  if (m_logSink != 0)
+    {
+      return;
+    }
 
-  std::string dLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "downloadLog.txt";
-  downloadLog.open (dLog.c_str ());
-  downloadLog << "Segment_Index Download_Request_Sent Download_Start Download_End Segment_Size Download_OK\n";
-  downloadLog.flush ();
-
-  std::string pLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "playbackLog.txt";
-  playbackLog.open (pLog.c_str ());
-  playbackLog << "Segment_Index Playback_Start Quality_Level\n";
-  playbackLog.flush ();
-
-  std::string aLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "adaptationLog.txt";
-  adaptationLog.open (aLog.c_str ());
-  adaptationLog << "Segment_Index Rep_Level Decision_Point_Of_Time Case DelayCase\n";
-  adaptationLog.flush ();
-
-  std::string bLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "bufferLog.txt";
-  bufferLog.open (bLog.c_str ());
-  bufferLog << "     Time_Now  Buffer_Level \n";
-  bufferLog.flush ();
-
-  std::string tLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "throughputLog.txt";
-  throughputLog.open (tLog.c_str ());
-  throughputLog << "     Time_Now Bytes Received \n";
-  throughputLog.flush ();
-
-  std::string buLog = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_" + "cl" + clientId + "_"  + "bufferUnderrunLog.txt";
-  bufferUnderrunLog.open (buLog.c_str ());
-  bufferUnderrunLog << ("Buffer_Underrun_Started_At         Until \n");
-  bufferUnderrunLog.flush ();
+  std::string logPrefix = dashLogDirectory + m_algoName + "/" +  numberOfClients  + "/sim" + simulationId + "_";
+  if (m_logFormat == LOG_BINARY)
+    {
+      m_logSink = TcpStreamBinaryLogSink::Get (logPrefix + "log.bin");
+    }
+  else
+    {
+      m_logSink = Create<TcpStreamTextLogSink> (logPrefix + "cl" + clientId + "_");
+    }
 }
 
 } // Namespace ns3
@@ -21,16 +21,19 @@
 
 #include "ns3/application.h"
 #include "ns3/event-id.h"
+#include "ns3/nstime.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
 #include <iostream>
 #include <fstream>
 #include "tcp-stream-adaptation-algorithm.h"
+#include "tcp-stream-controller.h"
 #include "tcp-stream-interface.h"
 #include "tobasco2.h"
 #include "festive.h"
 #include "panda.h"
+#include "tcp-stream-log-sink.h"
 
 
 namespace ns3 {
@@ -43,8 +46,9 @@ class Packet;
  * \brief A Tcp Stream client
  *
  * Every segment size request sent is returned by the server and received here.
+ * The controller state machine deciding on the requests is shared with AbrTraceSession, see TcpStreamController.
  */
-class TcpStreamClient : public Application
+class TcpStreamClient : public Application, public TcpStreamController
 {
 
 public:
@@ -85,67 +89,49 @@ public:
    */
   void SetRemote (Address ip, uint16_t port);
 
-protected:
-  virtual void DoDispose (void);
-
-private:
   /**
-   * \brief This enum is used to define the states of the state machine which controls the behaviour of the client.
+   * \brief Format of the log files written by the client, if no log sink is set explicitly.
    */
-  enum controllerState
+  enum LogFormat
   {
-    initial, downloading, downloadingPlaying, playing, terminal
+    LOG_TEXT, //!< six text files per client, see TcpStreamTextLogSink
+    LOG_BINARY //!< one binary file shared by all clients of the simulation, see TcpStreamBinaryLogSink
   };
-  controllerState state;
 
   /**
-   * \brief This enum is used to define the controller events of the state machine which controls the behaviour of the client.
+   * \brief Granularity of the throughput log.
    */
-  enum controllerEvent
+  enum ThroughputSampling
   {
-    downloadFinished, playbackFinished, irdFinished, init
+    THROUGHPUT_PACKET, //!< one record per received packet: arrival time and packet size
+    THROUGHPUT_BIN, //!< one record per non-empty time bin: start of the bin and bytes received during the bin
+    THROUGHPUT_SEGMENT //!< one record per segment: end of the transmission and segment size
   };
-  AdaptationAlgorithm *algo;
-
-  virtual void StartApplication (void);
-  virtual void StopApplication (void);
 
   /**
-   * \brief Finite state machine controlling the client.
+   * \brief Set the sink receiving all log records of this client.
    *
-   * When a client object is created, it is initiated as follows and finds itself in state initial:
-   * - It creates an adaptation algorithm object of the kind specified for this particular simulation.
-   * - The reduced version of the MPD, containing the duration of a segment in microseconds and a (n x m) matrix consisting of n representations and m segment sizes, denoted in bytes, is being read in from the file specified at program start.
-   * - The log files are being initialised.
-   *
-   * After these initialisations, which take place at object creation, a TCP connection to the server is initiated and the callbacks for a succeeded connection and for receiving are set. Then, the controller does the transition initial init-> downloading by calling RequestRepIndex (), thus obtaining the next representation level to be downloaded. The client then requests the determined segment size from the server by sending it a string composed of the number of bytes of the segment. After the request is processed by the server, it starts sending the first TCP packet to the client. The receiving of a packet notifies the socket that new data is available to be read, so the aforementioned SetRcvCallback is triggered and the client stars receiving packets. Meanwhile all arrived packets are being logged. This is repeated until the received amount of data matches the requested segment size. Then, the throughput is logged and the receive function calls the controller with the event  downloadFinished.
-   * The controller then adds a segment to the buffer and calls the PlaybackHandle() function. Here, the segment buffer is decremented by one segment, thus simulating the beginning of playback. Then, the function returns to the controller, where a timer of m_segmentDuration microseconds is set to call PlaybackHandle() again, after playback of the prior segment is finished. Next, the requests the next segment as described before. Therefore, the controller does the transition downloading downloadfinished-> downloadingPlaying.
-
-   * Now being in state downloadingPlaying, the next possible transitions are
-   * - downloadingPlaying downloadFinished-> downloadingPlaying: download of a segment is finished. The download of the next segment is started.
-   * - downloadingPlaying playbackFinished-> downloadingPlaying: playback of a segment is finished. The controller calls PlaybackHandle(), which happens through the beforehand set timer; if the number of segments in the buffer is > 0, the segment buffer is decremented by 1, and the timer is set to call PlaybackHandle() in m_segmentDuration microseconds.
-   * - downloadingPlaying downloadFinished-> playing: download of a segment is finished. The controller will request the next representation level from the adaptation algorithm. If m_bDelay > 0, the controller delays the download of the next segment by m_bDelay. Streaming session is now performing playback only.
-   * - downloadingPlaying playbackFinished-> downloading: playback of a segment is finished. This event is triggered by the beforehand set timer. The controller calls PlaybackHandle(); if the number of segments in the buffer is == 0, a buffer underrun is logged.
-   * - downloadingPlaying downloadFinished-> playing: download of the last segment is finished. Playback of the remaining segment(s) in the buffer continues. After finishing playback of all remaining segments in the buffer, playing playbackFinished-> terminal is performed, thus closing the client's socket, the streaming session for this client ends.
-   * Assuming that a buffer underrun has just been encountered and the client is currently in state downloading, the client is currently busy downloading the next segment. After the segment is fully downloaded, the controller is notified, PlaybackHandle() is called, thus starting the playback of the just downloaded segment and the transition downloading downloadFinished-> downloadingPlaying is performed. If the just downloaded segment (after the buffer underrun) was the streaming session's last segment, downloading downloadFinished-> playing is performed, the last segment is played and playing playbackFinished-> terminal is performed, as explained before.
-   */
-  void Controller (controllerEvent action);
-  /**
-   * Set the data fill of the packet (what is actually sent as data to the server with m_data) to
-   * the zero-terminated contents of the T & message string.
+   * Replaces the sink created according to the LogFormat attribute, for example for sharing one custom
+   * sink between several clients.
    *
-   * \param message The amount of bytes the server shall send as a respond.
+   * \param sink the log sink
    */
-  template <typename T>
-  void PreparePacket (T & message);
+  void SetLogSink (Ptr<TcpStreamLogSink> sink);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
   /**
-   * \brief Send a packet to the server.
+   * \brief Send a segment request to the server.
    *
-   * Before a packet is sent, PreparePacket( T & message) is called to fill the packet with
-   * a string, containig the number of bytes requested from the server.
+   * The request is a TcpStreamRequestHeader carrying the index of the next segment, its representation
+   * level index and its size, i.e. the number of bytes the server shall return.
    */
-  template <typename T>
-  void Send (T & message);
+  virtual void Send ();
   /**
    * \brief Handle a packet reception.
    *
@@ -166,36 +152,28 @@ private:
   void ConnectionFailed (Ptr<Socket> socket);
   /**
    * Called after a segment was completely received from the server, meaning that the received number
-   * of bytes == the requested number of bytes. Throughput data and buffer data is logged.
+   * of bytes == the requested number of bytes. Hands the segment to TcpStreamController::SegmentReceived ().
    */
   void SegmentReceivedHandle ();
+  virtual int64_t GetAlgorithmClientId () const;
   /**
-   * \brief Read in bitrate values
-   *
-   * The test bitrate values to be read must be provided in bytes in absolute sizes (not per second!)
-   * as a 2x2 matrix, with spaces separating the segment sizes and newlines for every representation level.
+   * \brief Log the decision of the adaptation algorithm, see LogAdaptation ().
    */
-  int ReadInBitrateValues (std::string segmentSizeFile);
-  /*
-   * \brief Controls / simulates playback process
-   *
-   * Gets called by a timer, when the simulated playback of a segment is finished.
-   * If m_segmentsInBuffer > 0, then m_segmentsInBuffer is decremented and m_currentPlaybackIndex
-   * is incremented. Also, if there was a buffer underrun before, m_bufferUnderrun is set to false
-   * and the end of a buffer underrun is logged. If m_segmentsInBuffer == 0, a buffer underrun is
-   * registered by writing the event in the bufferUnderrun logfile and m_bufferUnderrun is set to true.
-   *
-   * \return true if there is a buffer underrun
+  virtual void NotifyRepIndex (const algorithmReply &answer);
+  /**
+   * \brief Log the download, the buffer level and, if ThroughputSampling is Segment, the throughput.
    */
-  bool PlaybackHandle ();
-  /*
-   * \brief Request the next representation index from algorithm.
-   *
-   * The client requests the next representation index by calling algo->GetNextRep (int64_t m_segmentCounter), which is the interface between an adaptation algorithm
-   * and a client, specifying the current segment index as an argument.
-   * The algorithm returns an algorithmReply struct, the received values are stored in local variables for logging purposes.
+  virtual void NotifySegmentReceived ();
+  /**
+   * \brief Log the start of the playback of a segment, see LogPlayback ().
    */
-  void RequestRepIndex ();
+  virtual void NotifyPlayback (int64_t timeNow);
+  virtual void NotifyBufferUnderrunStart (int64_t timeNow);
+  virtual void NotifyBufferUnderrunEnd (int64_t timeNow);
+  /**
+   * \brief Stop the application after the playback of the last segment has started.
+   */
+  virtual void NotifyTerminal ();
   /*
    * \brief Log segment download information
    *
@@ -226,6 +204,13 @@ private:
    * - size of packet
    */
   void LogThroughput (uint32_t packetSize);
+  /*
+   * \brief Add a received packet to the current throughput time bin
+   *
+   * When the packet arrives after the end of the current bin, the bytes received during the
+   * current bin are logged and a new bin, aligned to a multiple of m_throughputBinSize, is started.
+   */
+  void SampleThroughput (uint32_t packetSize);
   /*
    * \brief Log information about playback process
    *
@@ -244,16 +229,13 @@ private:
    */
   void LogAdaptation (algorithmReply answer);
   /*
-   * \brief Open log output files with streams.
+   * \brief Create the log sink.
    *
-   * The output streams defined in TcpStreamClient are opened,
-   * and log files containing the used adaptation algorithm are created for output.
+   * Unless a log sink has been set with SetLogSink (), a sink according to the LogFormat attribute is created,
+   * writing to log files containing the used adaptation algorithm in their path.
    */
   void InitializeLogFiles (std::string simulationId, std::string clientId, std::string numberOfClients);
 
-  uint32_t m_dataSize; //!< packet payload size
-  uint8_t *m_data; //!< packet payload data
-
   Ptr<Socket> m_socket; //!< Socket
   Address m_peerAddress; //!< Remote peer address
   uint16_t m_peerPort; //!< Remote peer port
@@ -263,32 +245,16 @@ private:
   uint16_t m_numberOfClients; //!< The total number of clients for this simulation, for logging purposes
   std::string m_segmentSizeFilePath; //!< The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes
   std::string m_algoName;//!< Name of the apation algorithm's class which this client will use for the simulation
-  bool m_bufferUnderrun; //!< True if there is currently a buffer underrun in the simulated playback
-  int64_t m_currentPlaybackIndex; //!< The index of the segment that is currently being played
-  int64_t m_segmentsInBuffer; //!< The number of segments that are currently in the buffer
-  int64_t m_currentRepIndex; //!< The index of the currently requested segment quality
-  int64_t m_lastSegmentIndex;//!< The index of the last segment, i.e. the total number of segments-1
-  int64_t m_segmentCounter; //!< The index of the next segment to be downloaded
-  int64_t m_transmissionStartReceivingSegment; //!< The point in time in microseconds when the transmission of a segment begins
-  int64_t m_transmissionEndReceivingSegment; //!< The point in time in microseconds when the transmission of a segment is finished
   int64_t m_bytesReceived; //!< Counts the amount of received bytes of the current packet
-  int64_t m_bDelay;  //!< Minimum buffer level in microseconds of playback when the next download must be started
-  int64_t m_highestRepIndex; //!< This is the index of the highest representation
   uint64_t m_segmentDuration; //!< The duration of a segment in microseconds
 
-  std::ofstream adaptationLog; //!< Output stream for logging adaptation information
-  std::ofstream downloadLog; //!< Output stream for logging download information
-  std::ofstream playbackLog; //!< Output stream for logging playback information
-  std::ofstream bufferLog; //!< Output stream for logging buffer course
-  std::ofstream throughputLog; //!< Output stream for logging throughput information
-  std::ofstream bufferUnderrunLog; //!< Output stream for logging starting and ending of buffer underruns
-
-  uint64_t m_downloadRequestSent; //!< Logging the point in time in microseconds when a download request was sent to the server
-
-  throughputData m_throughput; //!< Tracking the throughput
-  bufferData m_bufferData; //!< Keep track of the buffer level
-  playbackData m_playbackData; //!< Tracking the simulated playback of segments
-  videoData m_videoData; //!< Information about segment sizes, average bitrates of representation levels and segment duration in microseconds
+  LogFormat m_logFormat; //!< Format of the log files, if no log sink is set explicitly
+  Ptr<TcpStreamLogSink> m_logSink; //!< Receives all log records of this client
+  ThroughputSampling m_throughputSampling; //!< Granularity of the throughput log
+  Time m_throughputBinSize; //!< Duration of a time bin of the throughput log
+  uint32_t m_historyDepth; //!< Number of most recent history entries kept, 0 for the whole history
+  int64_t m_throughputBinStart; //!< Start of the current throughput time bin in microseconds
+  int64_t m_throughputBinBytes; //!< Bytes received during the current throughput time bin
 
 };
 
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-controller.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "tcp-stream-adaptation-algorithm.h"
+#include "tobasco2.h"
+#include "panda.h"
+#include "festive.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamController");
+
+TcpStreamController::TcpStreamController ()
+  : state (initial),
+    algo (NULL),
+    m_bufferUnderrun (false),
+    m_currentPlaybackIndex (0),
+    m_segmentsInBuffer (0),
+    m_currentRepIndex (0),
+    m_lastSegmentIndex (0),
+    m_highestRepIndex (0),
+    m_segmentCounter (0),
+    m_bDelay (0),
+    m_downloadRequestSent (0),
+    m_transmissionStartReceivingSegment (0),
+    m_transmissionEndReceivingSegment (0)
+{
+}
+
+TcpStreamController::~TcpStreamController ()
+{
+  delete algo;
+  algo = NULL;
+}
+
+bool
+TcpStreamController::CreateAlgorithm (std::string algorithm)
+{
+  NS_LOG_FUNCTION (this << algorithm);
+  NS_ASSERT_MSG (m_videoData != 0, "The video data must be set before creating the adaptation algorithm");
+  m_lastSegmentIndex = m_videoData->numberOfSegments - 1;
+  m_highestRepIndex = m_videoData->averageBitrate.size () - 1;
+  if (algorithm == "tobasco")
+    {
+      algo = new TobascoAlgorithm (*m_videoData, m_playbackData, m_bufferData, m_throughput);
+    }
+  else if (algorithm == "panda")
+    {
+      algo = new PandaAlgorithm (*m_videoData, m_playbackData, m_bufferData, m_throughput);
+    }
+  else if (algorithm == "festive")
+    {
+      algo = new FestiveAlgorithm (*m_videoData, m_playbackData, m_bufferData, m_throughput);
+    }
+  else
+    {
+      NS_LOG_ERROR ("Invalid algorithm name " << algorithm);
+      return false;
+    }
+  return true;
+}
+
+void
+TcpStreamController::Controller (controllerEvent event)
+{
+  NS_LOG_FUNCTION (this);
+  if (state == initial)
+    {
+      RequestRepIndex ();
+      state = downloading;
+      Send ();
+      return;
+    }
+
+  if (state == downloading)
+    {
+      PlaybackHandle ();
+      if (m_currentPlaybackIndex <= m_lastSegmentIndex)
+        {
+          /*  e_d  */
+          m_segmentCounter++;
+          RequestRepIndex ();
+          state = downloadingPlaying;
+          Send ();
+        }
+      else
+        {
+          /*  e_df  */
+          state = playing;
+        }
+      controllerEvent ev = playbackFinished;
+      Simulator::Schedule (MicroSeconds (m_videoData->segmentDuration), &TcpStreamController::Controller, this, ev);
+      return;
+    }
+
+
+  else if (state == downloadingPlaying)
+    {
+      if (event == downloadFinished)
+        {
+          if (m_segmentCounter < m_lastSegmentIndex)
+            {
+              m_segmentCounter++;
+              RequestRepIndex ();
+            }
+
+          if (m_bDelay > 0 && m_segmentCounter <= m_lastSegmentIndex)
+            {
+              /*  e_dirs */
+              state = playing;
+              controllerEvent ev = irdFinished;
+              Simulator::Schedule (MicroSeconds (m_bDelay), &TcpStreamController::Controller, this, ev);
+            }
+          else if (m_segmentCounter == m_lastSegmentIndex)
+            {
+              /*  e_df  */
+              state = playing;
+            }
+          else
+            {
+              /*  e_d  */
+              Send ();
+            }
+        }
+      else if (event == playbackFinished)
+        {
+          if (!PlaybackHandle ())
+            {
+              /*  e_pb  */
+              controllerEvent ev = playbackFinished;
+              Simulator::Schedule (MicroSeconds (m_videoData->segmentDuration), &TcpStreamController::Controller, this, ev);
+            }
+          else
+            {
+              /*  e_pu  */
+              state = downloading;
+            }
+        }
+      return;
+    }
+
+
+  else if (state == playing)
+    {
+      if (event == irdFinished)
+        {
+          /*  e_irc  */
+          state = downloadingPlaying;
+          Send ();
+        }
+      else if (event == playbackFinished && m_currentPlaybackIndex < m_lastSegmentIndex)
+        {
+          /*  e_pb  */
+          PlaybackHandle ();
+          controllerEvent ev = playbackFinished;
+          Simulator::Schedule (MicroSeconds (m_videoData->segmentDuration), &TcpStreamController::Controller, this, ev);
+        }
+      else if (event == playbackFinished && m_currentPlaybackIndex == m_lastSegmentIndex)
+        {
+          PlaybackHandle ();
+          /*  e_pf  */
+          state = terminal;
+          NotifyTerminal ();
+        }
+      return;
+    }
+}
+
+void
+TcpStreamController::RequestRepIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  algorithmReply answer;
+
+  answer = algo->GetNextRep (m_segmentCounter, GetAlgorithmClientId ());
+  m_currentRepIndex = answer.nextRepIndex;
+  NS_ASSERT_MSG (answer.nextRepIndex <= m_highestRepIndex, "The algorithm returned a representation index that's higher than the maximum");
+
+  m_playbackData.playbackIndex.push_back (answer.nextRepIndex);
+  m_bDelay = answer.nextDownloadDelay;
+  NotifyRepIndex (answer);
+}
+
+void
+TcpStreamController::SegmentReceived ()
+{
+  NS_LOG_FUNCTION (this);
+  m_bufferData.timeNow.push_back (m_transmissionEndReceivingSegment);
+  if (m_segmentCounter > 0)
+    { //if a buffer underrun is encountered, the old buffer level will be set to 0, because the buffer can not be negative
+      m_bufferData.bufferLevelOld.push_back (std::max (m_bufferData.bufferLevelNew.back () -
+                                                       (m_transmissionEndReceivingSegment - m_throughput.transmissionEnd.back ()), (int64_t)0));
+    }
+  else //first segment
+    {
+      m_bufferData.bufferLevelOld.push_back (0);
+    }
+  m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelOld.back () + m_videoData->segmentDuration);
+
+  m_throughput.bytesReceived.push_back (m_videoData->GetSegmentSize (m_currentRepIndex, m_segmentCounter));
+  m_throughput.transmissionStart.push_back (m_transmissionStartReceivingSegment);
+  m_throughput.transmissionRequested.push_back (m_downloadRequestSent);
+  m_throughput.transmissionEnd.push_back (m_transmissionEndReceivingSegment);
+
+  algo->SegmentReceived (m_segmentCounter);
+
+  NotifySegmentReceived ();
+
+  m_segmentsInBuffer++;
+  if (m_segmentCounter == m_lastSegmentIndex)
+    {
+      m_bDelay = 0;
+    }
+
+  controllerEvent event = downloadFinished;
+  Controller (event);
+}
+
+bool
+TcpStreamController::PlaybackHandle ()
+{
+  NS_LOG_FUNCTION (this);
+  int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
+  // if we got called and there are no segments left in the buffer, there is a buffer underrun
+  if (m_segmentsInBuffer == 0 && m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun)
+    {
+      m_bufferUnderrun = true;
+      NotifyBufferUnderrunStart (timeNow);
+      return true;
+    }
+  else if (m_segmentsInBuffer > 0)
+    {
+      if (m_bufferUnderrun)
+        {
+          m_bufferUnderrun = false;
+          NotifyBufferUnderrunEnd (timeNow);
+        }
+      m_playbackData.playbackStart.push_back (timeNow);
+      NotifyPlayback (timeNow);
+      m_segmentsInBuffer--;
+      m_currentPlaybackIndex++;
+      // the representations of the segment played last and the following ones are still read
+      m_playbackData.SetPlaybackPosition (m_currentPlaybackIndex - 1);
+      return false;
+    }
+
+  return true;
+}
+
+int64_t
+TcpStreamController::GetAlgorithmClientId () const
+{
+  return 0;
+}
+
+void
+TcpStreamController::NotifyRepIndex (const algorithmReply &answer)
+{
+}
+
+void
+TcpStreamController::NotifySegmentReceived ()
+{
+}
+
+void
+TcpStreamController::NotifyPlayback (int64_t timeNow)
+{
+}
+
+void
+TcpStreamController::NotifyBufferUnderrunStart (int64_t timeNow)
+{
+}
+
+void
+TcpStreamController::NotifyBufferUnderrunEnd (int64_t timeNow)
+{
+}
+
+void
+TcpStreamController::NotifyTerminal ()
+{
+}
+
+} // namespace ns3
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_CONTROLLER_H
+#define TCP_STREAM_CONTROLLER_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/ptr.h"
+#include "tcp-stream-interface.h"
+
+namespace ns3 {
+
+class AdaptationAlgorithm;
+
+/**
+ * \ingroup tcpStream
+ * \brief The controller state machine of a streaming client, without the transport of the segments.
+ *
+ * Keeps the throughput, buffer and playback history the adaptation algorithm works on, decides when
+ * segments are requested and simulates their playback. Subclasses send the requests and report the
+ * end of every download through SegmentReceived (); the Notify methods let them log or measure the
+ * session. TcpStreamClient downloads the segments over TCP, AbrTraceSession replays a throughput trace.
+ */
+class TcpStreamController
+{
+public:
+  TcpStreamController ();
+  virtual ~TcpStreamController ();
+
+protected:
+  /**
+   * \brief This enum is used to define the states of the state machine which controls the behaviour of the client.
+   */
+  enum controllerState
+  {
+    initial, downloading, downloadingPlaying, playing, terminal
+  };
+
+  /**
+   * \brief This enum is used to define the controller events of the state machine which controls the behaviour of the client.
+   */
+  enum controllerEvent
+  {
+    downloadFinished, playbackFinished, irdFinished, init
+  };
+
+  /**
+   * \brief Create the adaptation algorithm streaming m_videoData, which must be set before.
+   *
+   * \param algorithm the name of the adaptation algorithm, "tobasco", "panda" or "festive"
+   * \return false if the algorithm is unknown
+   */
+  bool CreateAlgorithm (std::string algorithm);
+
+  /**
+   * \brief Finite state machine controlling the client.
+   *
+   * When a client object is created, it is initiated as follows and finds itself in state initial:
+   * - It creates an adaptation algorithm object of the kind specified for this particular simulation.
+   * - The reduced version of the MPD, containing the duration of a segment in microseconds and a (n x m) matrix consisting of n representations and m segment sizes, denoted in bytes, is being read in from the file specified at program start.
+   * - The log files are being initialised.
+   *
+   * After these initialisations, which take place at object creation, a TCP connection to the server is initiated and the callbacks for a succeeded connection and for receiving are set. Then, the controller does the transition initial init-> downloading by calling RequestRepIndex (), thus obtaining the next representation level to be downloaded. The client then requests the determined segment from the server by sending it a TcpStreamRequestHeader containing the segment index, the representation level index and the number of bytes of the segment. After the request is processed by the server, it starts sending the first TCP packet to the client. The receiving of a packet notifies the socket that new data is available to be read, so the aforementioned SetRcvCallback is triggered and the client stars receiving packets. Meanwhile all arrived packets are being logged. This is repeated until the received amount of data matches the requested segment size. Then, the throughput is logged and the receive function calls the controller with the event  downloadFinished.
+   * The controller then adds a segment to the buffer and calls the PlaybackHandle() function. Here, the segment buffer is decremented by one segment, thus simulating the beginning of playback. Then, the function returns to the controller, where a timer of m_segmentDuration microseconds is set to call PlaybackHandle() again, after playback of the prior segment is finished. Next, the requests the next segment as described before. Therefore, the controller does the transition downloading downloadfinished-> downloadingPlaying.
+
+   * Now being in state downloadingPlaying, the next possible transitions are
+   * - downloadingPlaying downloadFinished-> downloadingPlaying: download of a segment is finished. The download of the next segment is started.
+   * - downloadingPlaying playbackFinished-> downloadingPlaying: playback of a segment is finished. The controller calls PlaybackHandle(), which happens through the beforehand set timer; if the number of segments in the buffer is > 0, the segment buffer is decremented by 1, and the timer is set to call PlaybackHandle() in m_segmentDuration microseconds.
+   * - downloadingPlaying downloadFinished-> playing: download of a segment is finished. The controller will request the next representation level from the adaptation algorithm. If m_bDelay > 0, the controller delays the download of the next segment by m_bDelay. Streaming session is now performing playback only.
+   * - downloadingPlaying playbackFinished-> downloading: playback of a segment is finished. This event is triggered by the beforehand set timer. The controller calls PlaybackHandle(); if the number of segments in the buffer is == 0, a buffer underrun is logged.
+   * - downloadingPlaying downloadFinished-> playing: download of the last segment is finished. Playback of the remaining segment(s) in the buffer continues. After finishing playback of all remaining segments in the buffer, playing playbackFinished-> terminal is performed, thus closing the client's socket, the streaming session for this client ends.
+   * Assuming that a buffer underrun has just been encountered and the client is currently in state downloading, the client is currently busy downloading the next segment. After the segment is fully downloaded, the controller is notified, PlaybackHandle() is called, thus starting the playback of the just downloaded segment and the transition downloading downloadFinished-> downloadingPlaying is performed. If the just downloaded segment (after the buffer underrun) was the streaming session's last segment, downloading downloadFinished-> playing is performed, the last segment is played and playing playbackFinished-> terminal is performed, as explained before.
+   */
+  void Controller (controllerEvent event);
+  /*
+   * \brief Request the next representation index from algorithm.
+   *
+   * The client requests the next representation index by calling algo->GetNextRep (int64_t m_segmentCounter), which is the interface between an adaptation algorithm
+   * and a client, specifying the current segment index as an argument.
+   * The algorithm returns an algorithmReply struct, which is handed to NotifyRepIndex ().
+   */
+  void RequestRepIndex ();
+  /**
+   * \brief Record the download of the current segment in the history and notify the controller.
+   *
+   * To be called when the last byte of the segment has arrived, with m_downloadRequestSent,
+   * m_transmissionStartReceivingSegment and m_transmissionEndReceivingSegment set.
+   */
+  void SegmentReceived ();
+  /*
+   * \brief Controls / simulates playback process
+   *
+   * Gets called by a timer, when the simulated playback of a segment is finished.
+   * If m_segmentsInBuffer > 0, then m_segmentsInBuffer is decremented and m_currentPlaybackIndex
+   * is incremented. Also, if there was a buffer underrun before, m_bufferUnderrun is set to false
+   * and the end of the buffer underrun is notified. If m_segmentsInBuffer == 0, a buffer underrun is
+   * notified and m_bufferUnderrun is set to true.
+   *
+   * \return true if there is a buffer underrun
+   */
+  bool PlaybackHandle ();
+
+  /**
+   * \brief Request segment m_segmentCounter in representation m_currentRepIndex.
+   */
+  virtual void Send () = 0;
+  /**
+   * \return the client id passed to the adaptation algorithm
+   */
+  virtual int64_t GetAlgorithmClientId () const;
+  /**
+   * \brief Called when the adaptation algorithm decided on the representation of the next segment.
+   */
+  virtual void NotifyRepIndex (const algorithmReply &answer);
+  /**
+   * \brief Called when the download of segment m_segmentCounter has been added to the history.
+   */
+  virtual void NotifySegmentReceived ();
+  /**
+   * \brief Called when the playback of segment m_currentPlaybackIndex starts at timeNow.
+   */
+  virtual void NotifyPlayback (int64_t timeNow);
+  /**
+   * \brief Called when the buffer runs empty at timeNow before the last segment has been played.
+   */
+  virtual void NotifyBufferUnderrunStart (int64_t timeNow);
+  /**
+   * \brief Called when the playback resumes at timeNow after a buffer underrun.
+   */
+  virtual void NotifyBufferUnderrunEnd (int64_t timeNow);
+  /**
+   * \brief Called when the playback of the last segment has started, the state machine is terminal then.
+   */
+  virtual void NotifyTerminal ();
+
+  controllerState state; //!< State of the controller
+  AdaptationAlgorithm *algo; //!< The adaptation algorithm, NULL until it is created
+  Ptr<const videoData> m_videoData; //!< Information about segment sizes, average bitrates of representation levels and segment duration in microseconds
+
+  throughputData m_throughput; //!< Tracking the throughput
+  bufferData m_bufferData; //!< Keep track of the buffer level
+  playbackData m_playbackData; //!< Tracking the simulated playback of segments
+
+  bool m_bufferUnderrun; //!< True if there is currently a buffer underrun in the simulated playback
+  int64_t m_currentPlaybackIndex; //!< The index of the segment that is currently being played
+  int64_t m_segmentsInBuffer; //!< The number of segments that are currently in the buffer
+  int64_t m_currentRepIndex; //!< The index of the currently requested segment quality
+  int64_t m_lastSegmentIndex;//!< The index of the last segment, i.e. the total number of segments-1
+  int64_t m_highestRepIndex; //!< This is the index of the highest representation
+  int64_t m_segmentCounter; //!< The index of the next segment to be downloaded
+  int64_t m_bDelay;  //!< Minimum buffer level in microseconds of playback when the next download must be started
+  int64_t m_downloadRequestSent; //!< The point in time in microseconds when the download request of the current segment was sent
+  int64_t m_transmissionStartReceivingSegment; //!< The point in time in microseconds when the transmission of a segment begins
+  int64_t m_transmissionEndReceivingSegment; //!< The point in time in microseconds when the transmission of a segment is finished
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_CONTROLLER_H */
@@ -18,10 +18,147 @@
 #ifndef TCP_STREAM_INTERFACE_H
 #define TCP_STREAM_INTERFACE_H
 
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <limits>
+#include "ns3/simple-ref-count.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+
 namespace ns3 {
 
 std::string const dashLogDirectory = "dash-log-files/";
 
+/*! \class HistoryBuffer tcp-stream-interface.h "model/tcp-stream-interface.h"
+ *  \ingroup tcpStream
+ *  \brief A per-segment history column, optionally bounded to the most recent entries.
+ *
+ * Offers the subset of the std::vector interface used by clients and adaptation algorithms. Entries are
+ * always addressed by their absolute index, i.e. the number of entries pushed before them. With a capacity
+ * of 0 the buffer keeps every entry. Otherwise it is a ring buffer keeping the capacity most recent entries,
+ * so only indices in [GetFirstIndex (), size ()) are accessible.
+ */
+template <typename T>
+class HistoryBuffer
+{
+public:
+  HistoryBuffer () : m_capacity (0), m_size (0), m_count (0), m_keepFrom (std::numeric_limits<size_t>::max ())
+  {
+  }
+
+  /**
+   * \brief Set the number of entries to keep, 0 for keeping all entries.
+   *
+   * Must be called before the first entry is pushed.
+   */
+  void SetCapacity (size_t capacity)
+  {
+    NS_ASSERT_MSG (m_size == 0, "The capacity of a history buffer can't be changed once it is in use");
+    m_capacity = capacity;
+    m_data.resize (capacity);
+  }
+
+  /**
+   * \return the number of entries kept at most, 0 if all entries are kept
+   */
+  size_t GetCapacity (void) const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * \brief Never drop the entries from index on, the ring grows if they exceed the capacity.
+   */
+  void KeepFrom (size_t index)
+  {
+    m_keepFrom = index;
+  }
+
+  /**
+   * \return the absolute index of the oldest accessible entry
+   */
+  size_t GetFirstIndex (void) const
+  {
+    return m_size - m_count;
+  }
+
+  void push_back (const T &value)
+  {
+    if (m_capacity == 0)
+      {
+        m_data.push_back (value);
+        m_size++;
+        m_count++;
+        return;
+      }
+    if (m_count == m_capacity && GetFirstIndex () >= m_keepFrom)
+      {
+        Grow (2 * m_capacity);
+      }
+    m_data[m_size % m_capacity] = value;
+    m_size++;
+    if (m_count < m_capacity)
+      {
+        m_count++;
+      }
+  }
+
+  /**
+   * \return the total number of entries ever pushed
+   */
+  size_t size (void) const
+  {
+    return m_size;
+  }
+
+  bool empty (void) const
+  {
+    return m_size == 0;
+  }
+
+  const T & at (size_t index) const
+  {
+    if (index >= m_size || index < GetFirstIndex ())
+      {
+        NS_ABORT_MSG ("History index " << index << " not in [" << GetFirstIndex () << ", " << m_size
+                                       << "), increase the history depth");
+      }
+    return m_capacity == 0 ? m_data[index] : m_data[index % m_capacity];
+  }
+
+  const T & operator[] (size_t index) const
+  {
+    return at (index);
+  }
+
+  const T & back (void) const
+  {
+    return at (m_size - 1);
+  }
+
+private:
+  /**
+   * \brief Move the accessible entries to a ring of the given capacity.
+   */
+  void Grow (size_t capacity)
+  {
+    std::vector<T> data (capacity);
+    for (size_t index = GetFirstIndex (); index < m_size; index++)
+      {
+        data[index % capacity] = m_data[index % m_capacity];
+      }
+    m_data.swap (data);
+    m_capacity = capacity;
+  }
+
+  std::vector<T> m_data; //!< the stored entries, a ring of m_capacity entries unless all entries are kept
+  size_t m_capacity; //!< number of entries kept at most, 0 for all
+  size_t m_size; //!< total number of entries ever pushed
+  size_t m_count; //!< number of accessible entries
+  size_t m_keepFrom; //!< absolute index of the oldest entry that must not be dropped
+};
+
 /*! \class algorithmReply tcp-stream-interface.h "model/tcp-stream-interface.h"
  *  \ingroup tcpStream
  *  \brief This struct contains the reply an adaptation algorithm returns to the client
@@ -51,10 +188,21 @@ struct algorithmReply
  */
 struct throughputData
 {
-  std::vector<int64_t> transmissionRequested;       //!< Simulation time in microseconds when a segment was requested by the client
-  std::vector<int64_t> transmissionStart;       //!< Simulation time in microseconds when the first packet of a segment was received
-  std::vector<int64_t> transmissionEnd;       //!< Simulation time in microseconds when the last packet of a segment was received
-  std::vector<int64_t> bytesReceived;       //!< Number of bytes received, i.e. segment size
+  HistoryBuffer<int64_t> transmissionRequested;       //!< Simulation time in microseconds when a segment was requested by the client
+  HistoryBuffer<int64_t> transmissionStart;       //!< Simulation time in microseconds when the first packet of a segment was received
+  HistoryBuffer<int64_t> transmissionEnd;       //!< Simulation time in microseconds when the last packet of a segment was received
+  HistoryBuffer<int64_t> bytesReceived;       //!< Number of bytes received, i.e. segment size
+
+  /**
+   * \brief Keep only the depth most recent entries of every column, 0 for keeping all entries.
+   */
+  void SetHistoryDepth (size_t depth)
+  {
+    transmissionRequested.SetCapacity (depth);
+    transmissionStart.SetCapacity (depth);
+    transmissionEnd.SetCapacity (depth);
+    bytesReceived.SetCapacity (depth);
+  }
 };
 
 /*! \class bufferData tcp-stream-interface.h "model/tcp-stream-interface.h"
@@ -65,23 +213,65 @@ struct throughputData
  */
 struct bufferData
 {
-  std::vector<int64_t> timeNow;       //!< current simulation time
-  std::vector<int64_t> bufferLevelOld;       //!< buffer level in microseconds before adding segment duration (in microseconds) of just downloaded segment
-  std::vector<int64_t> bufferLevelNew;       //!< buffer level in microseconds after adding segment duration (in microseconds) of just downloaded segment
+  HistoryBuffer<int64_t> timeNow;       //!< current simulation time
+  HistoryBuffer<int64_t> bufferLevelOld;       //!< buffer level in microseconds before adding segment duration (in microseconds) of just downloaded segment
+  HistoryBuffer<int64_t> bufferLevelNew;       //!< buffer level in microseconds after adding segment duration (in microseconds) of just downloaded segment
+
+  /**
+   * \brief Keep only the depth most recent entries of every column, 0 for keeping all entries.
+   */
+  void SetHistoryDepth (size_t depth)
+  {
+    timeNow.SetCapacity (depth);
+    bufferLevelOld.SetCapacity (depth);
+    bufferLevelNew.SetCapacity (depth);
+  }
 };
 
 /*! \class videoData tcp-stream-interface.h "model/tcp-stream-interface.h"
  *  \ingroup tcpStream
  *  \brief This is a struct containing video data.
  *
- * Reduced version of a MPEG-DASH Media Presentation Description (MPD), containing a 2D [i][j] matrix
- * containing the size of every segment j in representation level i, the average bitrate of every
+ * Reduced version of a MPEG-DASH Media Presentation Description (MPD), containing a (n x m) matrix
+ * holding the size of every segment j in representation level i, the average bitrate of every
  * representation level and the duration of a segment in microseconds.
+ *
+ * The matrix is stored contiguously in representation-major order, either in segmentSize or, for binary
+ * segment size files, in the memory-mapped file. Instances are immutable once loaded and are shared by
+ * every client and adaptation algorithm streaming the same file, see SegmentSizeManifest.
  */
-struct videoData
+struct videoData : public SimpleRefCount<videoData>
 {
-  std::vector < std::vector<int64_t > > segmentSize;       //!< vector holding representation levels in the first dimension and their particular segment sizes in bytes in the second dimension
+  videoData () : mappedSegmentSize (0), numberOfSegments (0), segmentDuration (0)
+  {
+  }
+
+  /**
+   * Virtual, so that a manifest keeping a file mapped can release it.
+   */
+  virtual ~videoData ()
+  {
+  }
+
+  /**
+   * \param repIndex the representation level index
+   * \param segmentIndex the segment index
+   * \return the size in bytes of segment segmentIndex in representation level repIndex
+   */
+  int64_t GetSegmentSize (int64_t repIndex, int64_t segmentIndex) const
+  {
+    if (repIndex < 0 || repIndex >= (int64_t) averageBitrate.size () || segmentIndex < 0 || segmentIndex >= numberOfSegments)
+      {
+        NS_ABORT_MSG ("No segment " << segmentIndex << " in representation level " << repIndex);
+      }
+    size_t index = repIndex * numberOfSegments + segmentIndex;
+    return mappedSegmentSize != 0 ? mappedSegmentSize[index] : segmentSize[index];
+  }
+
+  std::vector<int64_t> segmentSize;       //!< flat (n x m) matrix, the size of segment j of representation level i in bytes is at index i * numberOfSegments + j, empty if the matrix is mapped
+  const uint32_t *mappedSegmentSize;       //!< the flat matrix in a memory-mapped binary segment size file, 0 if it is held in segmentSize
   std::vector < double > averageBitrate;       //!< holding the average bitrate of a segment in representation i in bits
+  int64_t numberOfSegments;       //!< number of segments m in every representation level
   int64_t segmentDuration;       //!< duration of a segment in microseconds
 };
 
@@ -96,8 +286,34 @@ struct videoData
  */
 struct playbackData
 {
-  std::vector <int64_t> playbackIndex;       //!< Index of the video segment
-  std::vector <int64_t> playbackStart; //!< Point in time in microseconds when playback of this segment started
+  HistoryBuffer<int64_t> playbackIndex;       //!< Index of the video segment
+  HistoryBuffer<int64_t> playbackStart; //!< Point in time in microseconds when playback of this segment started
+
+  /**
+   * \brief Keep only the depth most recent entries of every column, 0 for keeping all entries.
+   *
+   * The playback reads the representation of the segment being played, which lags behind the most
+   * recent request by the number of buffered segments. playbackIndex therefore keeps every entry from
+   * the one passed to SetPlaybackPosition () on, growing beyond depth while more segments are buffered.
+   */
+  void SetHistoryDepth (size_t depth)
+  {
+    playbackStart.SetCapacity (depth);
+    if (depth > 0)
+      {
+        // the segment being played, the one played before and the one being downloaded
+        playbackIndex.SetCapacity (depth + 2);
+        playbackIndex.KeepFrom (0);
+      }
+  }
+
+  /**
+   * \brief Allow dropping the entries of playbackIndex before index, once they have been played.
+   */
+  void SetPlaybackPosition (size_t index)
+  {
+    playbackIndex.KeepFrom (index);
+  }
 };
 
 } // namespace ns3
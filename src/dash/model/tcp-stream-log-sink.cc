@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-log-sink.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamLogSink");
+
+namespace {
+
+char const logMagic[8] = { 'D', 'A', 'S', 'H', 'L', 'O', 'G', '1' };
+
+/**
+ * Size of a batch of binary records that is written out at once.
+ */
+size_t const batchCapacity = 1 << 20;
+
+/**
+ * Maximum number of int64_t values of a binary record.
+ */
+uint8_t const maxValueCount = 5;
+
+/**
+ * Size of the record header: type, reserved byte and client id.
+ */
+size_t const recordHeaderSize = 4;
+
+} // anonymous namespace
+
+TcpStreamLogSink::~TcpStreamLogSink ()
+{
+}
+
+TcpStreamTextLogSink::TcpStreamTextLogSink (std::string prefix)
+{
+  NS_LOG_FUNCTION (this << prefix);
+
+  std::string dLog = prefix + "downloadLog.txt";
+  downloadLog.open (dLog.c_str ());
+  downloadLog << "Segment_Index Download_Request_Sent Download_Start Download_End Segment_Size Download_OK\n";
+
+  std::string pLog = prefix + "playbackLog.txt";
+  playbackLog.open (pLog.c_str ());
+  playbackLog << "Segment_Index Playback_Start Quality_Level\n";
+
+  std::string aLog = prefix + "adaptationLog.txt";
+  adaptationLog.open (aLog.c_str ());
+  adaptationLog << "Segment_Index Rep_Level Decision_Point_Of_Time Case DelayCase\n";
+
+  std::string bLog = prefix + "bufferLog.txt";
+  bufferLog.open (bLog.c_str ());
+  bufferLog << "     Time_Now  Buffer_Level \n";
+
+  std::string tLog = prefix + "throughputLog.txt";
+  throughputLog.open (tLog.c_str ());
+  throughputLog << "     Time_Now Bytes Received \n";
+
+  std::string buLog = prefix + "bufferUnderrunLog.txt";
+  bufferUnderrunLog.open (buLog.c_str ());
+  bufferUnderrunLog << ("Buffer_Underrun_Started_At         Until \n");
+}
+
+TcpStreamTextLogSink::~TcpStreamTextLogSink ()
+{
+  NS_LOG_FUNCTION (this);
+  downloadLog.close ();
+  playbackLog.close ();
+  adaptationLog.close ();
+  bufferLog.close ();
+  throughputLog.close ();
+  bufferUnderrunLog.close ();
+}
+
+void
+TcpStreamTextLogSink::LogDownload (uint16_t clientId, int64_t segmentIndex, int64_t requestSent,
+                                   int64_t transmissionStart, int64_t transmissionEnd, int64_t segmentSize)
+{
+  downloadLog << std::setfill (' ') << std::setw (13) << segmentIndex << " "
+              << std::setfill (' ') << std::setw (21) << requestSent / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (14) << transmissionStart / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (12) << transmissionEnd / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (12) << segmentSize << " "
+              << std::setfill (' ') << std::setw (12) << "Y\n";
+}
+
+void
+TcpStreamTextLogSink::LogPlayback (uint16_t clientId, int64_t segmentIndex, int64_t playbackStart, int64_t repIndex)
+{
+  playbackLog << std::setfill (' ') << std::setw (13) << segmentIndex << " "
+              << std::setfill (' ') << std::setw (14) << playbackStart / (double)1000000 << " "
+              << std::setfill (' ') << std::setw (13) << repIndex << "\n";
+}
+
+void
+TcpStreamTextLogSink::LogAdaptation (uint16_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t decisionTime,
+                                     int64_t decisionCase, int64_t delayDecisionCase)
+{
+  adaptationLog << std::setfill (' ') << std::setw (13) << segmentIndex << " "
+                << std::setfill (' ') << std::setw (9) << repIndex << " "
+                << std::setfill (' ') << std::setw (22) << decisionTime / (double)1000000 << " "
+                << std::setfill (' ') << std::setw (4) << decisionCase << " "
+                << std::setfill (' ') << std::setw (9) << delayDecisionCase << "\n";
+}
+
+void
+TcpStreamTextLogSink::LogBuffer (uint16_t clientId, int64_t timeNow, int64_t bufferLevelOld, int64_t bufferLevelNew)
+{
+  bufferLog << std::setfill (' ') << std::setw (13) << timeNow / (double)1000000 << " "
+            << std::setfill (' ') << std::setw (13) << bufferLevelOld / (double)1000000 << "\n"
+            << std::setfill (' ') << std::setw (13) << timeNow / (double)1000000 << " "
+            << std::setfill (' ') << std::setw (13) << bufferLevelNew / (double)1000000 << "\n";
+}
+
+void
+TcpStreamTextLogSink::LogThroughput (uint16_t clientId, int64_t timeNow, int64_t packetSize)
+{
+  throughputLog << std::setfill (' ') << std::setw (13) << timeNow / (double) 1000000 << " "
+                << std::setfill (' ') << std::setw (13) << packetSize << "\n";
+}
+
+void
+TcpStreamTextLogSink::LogBufferUnderrunStart (uint16_t clientId, int64_t timeNow)
+{
+  bufferUnderrunLog << std::setfill (' ') << std::setw (26) << timeNow / (double)1000000 << " ";
+}
+
+void
+TcpStreamTextLogSink::LogBufferUnderrunEnd (uint16_t clientId, int64_t timeNow)
+{
+  bufferUnderrunLog << std::setfill (' ') << std::setw (13) << timeNow / (double)1000000 << "\n";
+}
+
+void
+TcpStreamTextLogSink::Flush (void)
+{
+  downloadLog.flush ();
+  playbackLog.flush ();
+  adaptationLog.flush ();
+  bufferLog.flush ();
+  throughputLog.flush ();
+  bufferUnderrunLog.flush ();
+}
+
+TcpStreamBinaryLogSink::SinkMap &
+TcpStreamBinaryLogSink::GetRegistry ()
+{
+  static SinkMap registry;
+  return registry;
+}
+
+Ptr<TcpStreamBinaryLogSink>
+TcpStreamBinaryLogSink::Get (std::string binaryFile)
+{
+  NS_LOG_FUNCTION (binaryFile);
+  SinkMap &registry = GetRegistry ();
+  SinkMap::const_iterator it = registry.find (binaryFile);
+  if (it != registry.end ())
+    {
+      return Ptr<TcpStreamBinaryLogSink> (it->second);
+    }
+  Ptr<TcpStreamBinaryLogSink> sink = Ptr<TcpStreamBinaryLogSink> (new TcpStreamBinaryLogSink (binaryFile), false);
+  registry[binaryFile] = PeekPointer (sink);
+  return sink;
+}
+
+TcpStreamBinaryLogSink::TcpStreamBinaryLogSink (std::string binaryFile)
+  : m_binaryFile (binaryFile),
+    m_batch (batchCapacity),
+    m_batchSize (0)
+{
+  NS_LOG_FUNCTION (this << binaryFile);
+  m_file = fopen (binaryFile.c_str (), "wb");
+  NS_ASSERT_MSG (m_file != 0, "Couldn't open binary log file " << binaryFile);
+  fwrite (logMagic, 1, sizeof (logMagic), m_file);
+}
+
+TcpStreamBinaryLogSink::~TcpStreamBinaryLogSink ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  fclose (m_file);
+  GetRegistry ().erase (m_binaryFile);
+}
+
+void
+TcpStreamBinaryLogSink::AddRecord (RecordType type, uint16_t clientId, const int64_t *values, uint8_t count)
+{
+  size_t recordSize = recordHeaderSize + count * sizeof (int64_t);
+  if (m_batchSize + recordSize > m_batch.size ())
+    {
+      Flush ();
+    }
+  uint8_t *record = &m_batch[m_batchSize];
+  record[0] = type;
+  record[1] = 0;
+  std::memcpy (record + 2, &clientId, sizeof (clientId));
+  std::memcpy (record + recordHeaderSize, values, count * sizeof (int64_t));
+  m_batchSize += recordSize;
+}
+
+uint8_t
+TcpStreamBinaryLogSink::GetValueCount (uint8_t type)
+{
+  switch (type)
+    {
+    case DOWNLOAD:
+      return 5;
+    case PLAYBACK:
+      return 3;
+    case ADAPTATION:
+      return 5;
+    case BUFFER:
+      return 3;
+    case THROUGHPUT:
+      return 2;
+    case UNDERRUN_START:
+    case UNDERRUN_END:
+      return 1;
+    default:
+      return 0;
+    }
+}
+
+void
+TcpStreamBinaryLogSink::LogDownload (uint16_t clientId, int64_t segmentIndex, int64_t requestSent,
+                                     int64_t transmissionStart, int64_t transmissionEnd, int64_t segmentSize)
+{
+  int64_t values[] = { segmentIndex, requestSent, transmissionStart, transmissionEnd, segmentSize };
+  AddRecord (DOWNLOAD, clientId, values, GetValueCount (DOWNLOAD));
+}
+
+void
+TcpStreamBinaryLogSink::LogPlayback (uint16_t clientId, int64_t segmentIndex, int64_t playbackStart, int64_t repIndex)
+{
+  int64_t values[] = { segmentIndex, playbackStart, repIndex };
+  AddRecord (PLAYBACK, clientId, values, GetValueCount (PLAYBACK));
+}
+
+void
+TcpStreamBinaryLogSink::LogAdaptation (uint16_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t decisionTime,
+                                       int64_t decisionCase, int64_t delayDecisionCase)
+{
+  int64_t values[] = { segmentIndex, repIndex, decisionTime, decisionCase, delayDecisionCase };
+  AddRecord (ADAPTATION, clientId, values, GetValueCount (ADAPTATION));
+}
+
+void
+TcpStreamBinaryLogSink::LogBuffer (uint16_t clientId, int64_t timeNow, int64_t bufferLevelOld, int64_t bufferLevelNew)
+{
+  int64_t values[] = { timeNow, bufferLevelOld, bufferLevelNew };
+  AddRecord (BUFFER, clientId, values, GetValueCount (BUFFER));
+}
+
+void
+TcpStreamBinaryLogSink::LogThroughput (uint16_t clientId, int64_t timeNow, int64_t packetSize)
+{
+  int64_t values[] = { timeNow, packetSize };
+  AddRecord (THROUGHPUT, clientId, values, GetValueCount (THROUGHPUT));
+}
+
+void
+TcpStreamBinaryLogSink::LogBufferUnderrunStart (uint16_t clientId, int64_t timeNow)
+{
+  AddRecord (UNDERRUN_START, clientId, &timeNow, GetValueCount (UNDERRUN_START));
+}
+
+void
+TcpStreamBinaryLogSink::LogBufferUnderrunEnd (uint16_t clientId, int64_t timeNow)
+{
+  AddRecord (UNDERRUN_END, clientId, &timeNow, GetValueCount (UNDERRUN_END));
+}
+
+void
+TcpStreamBinaryLogSink::Flush (void)
+{
+  if (m_batchSize > 0)
+    {
+      fwrite (&m_batch[0], 1, m_batchSize, m_file);
+      m_batchSize = 0;
+    }
+  fflush (m_file);
+}
+
+int64_t
+TcpStreamBinaryLogSink::Decode (std::string binaryFile, std::string textPrefix)
+{
+  NS_LOG_FUNCTION (binaryFile << textPrefix);
+  FILE *file = fopen (binaryFile.c_str (), "rb");
+  if (file == 0)
+    {
+      return -1;
+    }
+  char magic[sizeof (logMagic)];
+  if (fread (magic, 1, sizeof (magic), file) != sizeof (magic)
+      || std::memcmp (magic, logMagic, sizeof (logMagic)) != 0)
+    {
+      NS_LOG_ERROR (binaryFile << " is not a binary log file.");
+      fclose (file);
+      return -1;
+    }
+
+  std::map<uint16_t, Ptr<TcpStreamLogSink> > clients;
+  int64_t records = 0;
+  uint8_t header[recordHeaderSize];
+  int64_t v[maxValueCount];
+  while (fread (header, 1, recordHeaderSize, file) == recordHeaderSize)
+    {
+      uint8_t count = GetValueCount (header[0]);
+      if (count == 0 || fread (v, sizeof (int64_t), count, file) != count)
+        {
+          NS_LOG_ERROR ("Truncated or corrupt record in " << binaryFile);
+          break;
+        }
+      uint16_t clientId;
+      std::memcpy (&clientId, header + 2, sizeof (clientId));
+      Ptr<TcpStreamLogSink> &sink = clients[clientId];
+      if (sink == 0)
+        {
+          std::ostringstream prefix;
+          prefix << textPrefix << "cl" << clientId << "_";
+          sink = Create<TcpStreamTextLogSink> (prefix.str ());
+        }
+      switch (header[0])
+        {
+        case DOWNLOAD:
+          sink->LogDownload (clientId, v[0], v[1], v[2], v[3], v[4]);
+          break;
+        case PLAYBACK:
+          sink->LogPlayback (clientId, v[0], v[1], v[2]);
+          break;
+        case ADAPTATION:
+          sink->LogAdaptation (clientId, v[0], v[1], v[2], v[3], v[4]);
+          break;
+        case BUFFER:
+          sink->LogBuffer (clientId, v[0], v[1], v[2]);
+          break;
+        case THROUGHPUT:
+          sink->LogThroughput (clientId, v[0], v[1]);
+          break;
+        case UNDERRUN_START:
+          sink->LogBufferUnderrunStart (clientId, v[0]);
+          break;
+        case UNDERRUN_END:
+          sink->LogBufferUnderrunEnd (clientId, v[0]);
+          break;
+        }
+      records++;
+    }
+  fclose (file);
+  return records;
+}
+
+} // namespace ns3
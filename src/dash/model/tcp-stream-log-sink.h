@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_LOG_SINK_H
+#define TCP_STREAM_LOG_SINK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Destination of the log records a TcpStreamClient produces.
+ *
+ * All points in time are given in microseconds of simulation time.
+ */
+class TcpStreamLogSink : public SimpleRefCount<TcpStreamLogSink>
+{
+public:
+  virtual ~TcpStreamLogSink ();
+
+  /**
+   * \brief Log segment download information, see TcpStreamClient::LogDownload ()
+   */
+  virtual void LogDownload (uint16_t clientId, int64_t segmentIndex, int64_t requestSent,
+                            int64_t transmissionStart, int64_t transmissionEnd, int64_t segmentSize) = 0;
+  /**
+   * \brief Log information about playback process, see TcpStreamClient::LogPlayback ()
+   */
+  virtual void LogPlayback (uint16_t clientId, int64_t segmentIndex, int64_t playbackStart, int64_t repIndex) = 0;
+  /**
+   * \brief Log information about adaptation algorithm, see TcpStreamClient::LogAdaptation ()
+   */
+  virtual void LogAdaptation (uint16_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t decisionTime,
+                              int64_t decisionCase, int64_t delayDecisionCase) = 0;
+  /**
+   * \brief Log buffer level, see TcpStreamClient::LogBuffer ()
+   */
+  virtual void LogBuffer (uint16_t clientId, int64_t timeNow, int64_t bufferLevelOld, int64_t bufferLevelNew) = 0;
+  /**
+   * \brief Log throughput information, see TcpStreamClient::LogThroughput ()
+   *
+   * Depending on the ThroughputSampling attribute of the client, a record describes a single arriving
+   * TCP packet, a time bin starting at timeNow or a segment whose transmission ended at timeNow.
+   */
+  virtual void LogThroughput (uint16_t clientId, int64_t timeNow, int64_t packetSize) = 0;
+  /**
+   * \brief Log the start of a buffer underrun
+   */
+  virtual void LogBufferUnderrunStart (uint16_t clientId, int64_t timeNow) = 0;
+  /**
+   * \brief Log the end of a buffer underrun
+   */
+  virtual void LogBufferUnderrunEnd (uint16_t clientId, int64_t timeNow) = 0;
+  /**
+   * \brief Write out everything logged so far.
+   */
+  virtual void Flush (void) = 0;
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Log sink writing the six per-client text log files.
+ *
+ * The files are named <prefix>downloadLog.txt, <prefix>playbackLog.txt, <prefix>adaptationLog.txt,
+ * <prefix>bufferLog.txt, <prefix>throughputLog.txt and <prefix>bufferUnderrunLog.txt.
+ */
+class TcpStreamTextLogSink : public TcpStreamLogSink
+{
+public:
+  /**
+   * \param prefix path prefix of the log files of this client
+   */
+  TcpStreamTextLogSink (std::string prefix);
+  virtual ~TcpStreamTextLogSink ();
+
+  virtual void LogDownload (uint16_t clientId, int64_t segmentIndex, int64_t requestSent,
+                            int64_t transmissionStart, int64_t transmissionEnd, int64_t segmentSize);
+  virtual void LogPlayback (uint16_t clientId, int64_t segmentIndex, int64_t playbackStart, int64_t repIndex);
+  virtual void LogAdaptation (uint16_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t decisionTime,
+                              int64_t decisionCase, int64_t delayDecisionCase);
+  virtual void LogBuffer (uint16_t clientId, int64_t timeNow, int64_t bufferLevelOld, int64_t bufferLevelNew);
+  virtual void LogThroughput (uint16_t clientId, int64_t timeNow, int64_t packetSize);
+  virtual void LogBufferUnderrunStart (uint16_t clientId, int64_t timeNow);
+  virtual void LogBufferUnderrunEnd (uint16_t clientId, int64_t timeNow);
+  virtual void Flush (void);
+
+private:
+  std::ofstream adaptationLog; //!< Output stream for logging adaptation information
+  std::ofstream downloadLog; //!< Output stream for logging download information
+  std::ofstream playbackLog; //!< Output stream for logging playback information
+  std::ofstream bufferLog; //!< Output stream for logging buffer course
+  std::ofstream throughputLog; //!< Output stream for logging throughput information
+  std::ofstream bufferUnderrunLog; //!< Output stream for logging starting and ending of buffer underruns
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Log sink writing the records of all clients of a simulation into a single binary file.
+ *
+ * Records are collected in memory and written out in large batches. Every record consists of a
+ * uint8_t record type, a reserved uint8_t, the uint16_t client id and a fixed number of int64_t
+ * values depending on the record type, all in host byte order. The file starts with the 8 byte
+ * magic "DASHLOG1". Decode () turns a binary log file back into the per-client text log files.
+ */
+class TcpStreamBinaryLogSink : public TcpStreamLogSink
+{
+public:
+  /**
+   * \brief Get the binary log sink writing to a file, opening the file on first use.
+   *
+   * All clients asking for the same file share one sink. The file is closed when the last client
+   * releases it.
+   *
+   * \param binaryFile the path of the binary log file
+   * \return the shared sink
+   */
+  static Ptr<TcpStreamBinaryLogSink> Get (std::string binaryFile);
+
+  /**
+   * \brief Convert a binary log file into per-client text log files.
+   *
+   * The text log files of client i are written with prefix <textPrefix>cl<i>_, producing the same
+   * columns as TcpStreamTextLogSink.
+   *
+   * \param binaryFile the path of the binary log file
+   * \param textPrefix path prefix of the text log files
+   * \return the number of decoded records, or -1 if the file could not be read
+   */
+  static int64_t Decode (std::string binaryFile, std::string textPrefix);
+
+  virtual ~TcpStreamBinaryLogSink ();
+
+  virtual void LogDownload (uint16_t clientId, int64_t segmentIndex, int64_t requestSent,
+                            int64_t transmissionStart, int64_t transmissionEnd, int64_t segmentSize);
+  virtual void LogPlayback (uint16_t clientId, int64_t segmentIndex, int64_t playbackStart, int64_t repIndex);
+  virtual void LogAdaptation (uint16_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t decisionTime,
+                              int64_t decisionCase, int64_t delayDecisionCase);
+  virtual void LogBuffer (uint16_t clientId, int64_t timeNow, int64_t bufferLevelOld, int64_t bufferLevelNew);
+  virtual void LogThroughput (uint16_t clientId, int64_t timeNow, int64_t packetSize);
+  virtual void LogBufferUnderrunStart (uint16_t clientId, int64_t timeNow);
+  virtual void LogBufferUnderrunEnd (uint16_t clientId, int64_t timeNow);
+  virtual void Flush (void);
+
+  /**
+   * \brief Types of the records in a binary log file
+   */
+  enum RecordType
+  {
+    DOWNLOAD = 1, PLAYBACK, ADAPTATION, BUFFER, THROUGHPUT, UNDERRUN_START, UNDERRUN_END
+  };
+
+private:
+  /**
+   * \param binaryFile the path of the binary log file
+   */
+  TcpStreamBinaryLogSink (std::string binaryFile);
+
+  /**
+   * \brief Append a record to the in-memory batch, writing the batch out if it is full.
+   */
+  void AddRecord (RecordType type, uint16_t clientId, const int64_t *values, uint8_t count);
+
+  /**
+   * \return the number of int64_t values of a record of the given type, or 0 for an unknown type
+   */
+  static uint8_t GetValueCount (uint8_t type);
+
+  std::string m_binaryFile; //!< path of the binary log file
+  FILE *m_file; //!< the binary log file
+  std::vector<uint8_t> m_batch; //!< records not yet written to m_file
+  size_t m_batchSize; //!< number of valid bytes in m_batch
+
+  typedef std::map<std::string, TcpStreamBinaryLogSink *> SinkMap;
+  static SinkMap & GetRegistry ();
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_LOG_SINK_H */
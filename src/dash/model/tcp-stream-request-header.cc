@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-request-header.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamRequestHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamRequestHeader);
+
+TcpStreamRequestHeader::TcpStreamRequestHeader ()
+  : m_segmentIndex (0),
+    m_repIndex (0),
+    m_segmentSize (0)
+{
+}
+
+TypeId
+TcpStreamRequestHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamRequestHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamRequestHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpStreamRequestHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+TcpStreamRequestHeader::Print (std::ostream &os) const
+{
+  os << "segment=" << m_segmentIndex << " rep=" << m_repIndex << " size=" << m_segmentSize;
+}
+
+uint32_t
+TcpStreamRequestHeader::GetSerializedSize (void) const
+{
+  return 12;
+}
+
+void
+TcpStreamRequestHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_segmentIndex);
+  start.WriteHtonU32 (m_repIndex);
+  start.WriteHtonU32 (m_segmentSize);
+}
+
+uint32_t
+TcpStreamRequestHeader::Deserialize (Buffer::Iterator start)
+{
+  m_segmentIndex = start.ReadNtohU32 ();
+  m_repIndex = start.ReadNtohU32 ();
+  m_segmentSize = start.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+void
+TcpStreamRequestHeader::SetSegmentIndex (uint32_t segmentIndex)
+{
+  m_segmentIndex = segmentIndex;
+}
+
+uint32_t
+TcpStreamRequestHeader::GetSegmentIndex (void) const
+{
+  return m_segmentIndex;
+}
+
+void
+TcpStreamRequestHeader::SetRepIndex (uint32_t repIndex)
+{
+  m_repIndex = repIndex;
+}
+
+uint32_t
+TcpStreamRequestHeader::GetRepIndex (void) const
+{
+  return m_repIndex;
+}
+
+void
+TcpStreamRequestHeader::SetSegmentSize (uint32_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+
+uint32_t
+TcpStreamRequestHeader::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+} // namespace ns3
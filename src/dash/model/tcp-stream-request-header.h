@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_REQUEST_HEADER_H
+#define TCP_STREAM_REQUEST_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Segment request a TcpStreamClient sends to the TcpStreamServer.
+ *
+ * Fixed-size binary request carrying the index of the requested segment, its representation level
+ * index and the number of bytes the server shall return, all as 32 bit integers in network byte order.
+ */
+class TcpStreamRequestHeader : public Header
+{
+public:
+  TcpStreamRequestHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  /**
+   * \param segmentIndex the index of the requested segment
+   */
+  void SetSegmentIndex (uint32_t segmentIndex);
+  /**
+   * \return the index of the requested segment
+   */
+  uint32_t GetSegmentIndex (void) const;
+  /**
+   * \param repIndex the representation level index of the requested segment
+   */
+  void SetRepIndex (uint32_t repIndex);
+  /**
+   * \return the representation level index of the requested segment
+   */
+  uint32_t GetRepIndex (void) const;
+  /**
+   * \param segmentSize the number of bytes the server shall return
+   */
+  void SetSegmentSize (uint32_t segmentSize);
+  /**
+   * \return the number of bytes the server shall return
+   */
+  uint32_t GetSegmentSize (void) const;
+
+private:
+  uint32_t m_segmentIndex; //!< index of the requested segment
+  uint32_t m_repIndex; //!< representation level index of the requested segment
+  uint32_t m_segmentSize; //!< number of bytes the server shall return
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_REQUEST_HEADER_H */
@@ -31,6 +31,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/tcp-socket-factory.h"
 #include "tcp-stream-server.h"
+#include "tcp-stream-request-header.h"
 #include "ns3/global-value.h"
 #include <ns3/core-module.h>
 #include "tcp-stream-client.h"
@@ -58,6 +59,8 @@ TcpStreamServer::GetTypeId (void)
 }
 
 TcpStreamServer::TcpStreamServer ()
+  : m_connectedClients (0),
+    m_handledEvents (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -102,9 +105,6 @@ TcpStreamServer::StartApplication (void)
   // Accept connection requests from remote hosts.
   m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
                                MakeCallback (&TcpStreamServer::HandleAccept,this));
-  m_socket->SetCloseCallbacks (
-    MakeCallback (&TcpStreamServer::HandlePeerClose, this),
-    MakeCallback (&TcpStreamServer::HandlePeerError, this));
 }
 
 void
@@ -124,45 +124,88 @@ TcpStreamServer::StopApplication ()
     }
 }
 
+uint64_t
+TcpStreamServer::GetHandledEvents (void) const
+{
+  return m_handledEvents;
+}
+
+void
+TcpStreamServer::DoHandleRead (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket)
+{
+  server->HandleRead (connectionId, socket);
+}
+
 void
-TcpStreamServer::HandleRead (Ptr<Socket> socket)
+TcpStreamServer::DoHandleSend (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket, uint32_t txSpace)
 {
-  NS_LOG_FUNCTION (this << socket);
+  server->HandleSend (connectionId, socket, txSpace);
+}
+
+void
+TcpStreamServer::DoHandlePeerClose (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket)
+{
+  server->HandlePeerClose (connectionId, socket);
+}
+
+void
+TcpStreamServer::DoHandlePeerError (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket)
+{
+  server->HandlePeerError (connectionId, socket);
+}
+
+void
+TcpStreamServer::HandleRead (uint32_t connectionId, Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << connectionId << socket);
+  m_handledEvents++;
   Ptr<Packet> packet;
-  Address from;
-  packet = socket->RecvFrom (from);
-  int64_t packetSizeToReturn = GetCommand (packet);
-  // these values will be accessible by the clients Address from.
-  m_callbackData [from].currentTxBytes = 0;
-  m_callbackData [from].packetSizeToReturn = packetSizeToReturn;
-  m_callbackData [from].send = true;
+  packet = socket->Recv ();
+  if (packet == 0)
+    {
+      NS_LOG_WARN ("Nothing to read on connection " << connectionId);
+      return;
+    }
+  callbackData &cbd = m_callbackData [connectionId];
+  TcpStreamRequestHeader request;
+  if (!GetCommand (cbd, packet, request))
+    {
+      NS_LOG_INFO ("Connection " << connectionId << ": waiting for the rest of the request, "
+                                 << cbd.requestBytes << " bytes received so far");
+      return;
+    }
+  NS_LOG_INFO ("Connection " << connectionId << ": serving segment " << request.GetSegmentIndex ()
+                             << " of representation " << request.GetRepIndex ()
+                             << " (" << request.GetSegmentSize () << " bytes)");
+  cbd.currentTxBytes = 0;
+  cbd.packetSizeToReturn = request.GetSegmentSize ();
+  cbd.send = true;
 
-  HandleSend (socket, socket->GetTxAvailable ());
+  HandleSend (connectionId, socket, socket->GetTxAvailable ());
 
 }
 
 void
-TcpStreamServer::HandleSend (Ptr<Socket> socket, uint32_t txSpace)
+TcpStreamServer::HandleSend (uint32_t connectionId, Ptr<Socket> socket, uint32_t txSpace)
 {
-  Address from;
-  socket->GetPeerName (from);
-  // look up values for the connected client and whose values are stored in from
-  if (m_callbackData [from].currentTxBytes == m_callbackData [from].packetSizeToReturn)
+  m_handledEvents++;
+  callbackData &cbd = m_callbackData [connectionId];
+  if (cbd.currentTxBytes == cbd.packetSizeToReturn)
     {
-      m_callbackData [from].currentTxBytes = 0;
-      m_callbackData [from].packetSizeToReturn = 0;
-      m_callbackData [from].send = false;
+      cbd.currentTxBytes = 0;
+      cbd.packetSizeToReturn = 0;
+      cbd.send = false;
       return;
     }
-  if (socket->GetTxAvailable () > 0 && m_callbackData [from].send)
+  if (socket->GetTxAvailable () > 0 && cbd.send)
     {
       int32_t toSend;
-      toSend = std::min (socket->GetTxAvailable (), m_callbackData [from].packetSizeToReturn - m_callbackData [from].currentTxBytes);
+      toSend = std::min (socket->GetTxAvailable (), cbd.packetSizeToReturn - cbd.currentTxBytes);
       Ptr<Packet> packet = Create<Packet> (toSend);
       int amountSent = socket->Send (packet, 0);
       if (amountSent > 0)
         {
-          m_callbackData [from].currentTxBytes += amountSent;
+          cbd.currentTxBytes += amountSent;
         }
       // We exit this part, when no bytes have been sent, as the send side buffer is full.
       // The "HandleSend" callback will fire when some buffer space has freed up.
@@ -177,55 +220,97 @@ void
 TcpStreamServer::HandleAccept (Ptr<Socket> s, const Address& from)
 {
   NS_LOG_FUNCTION (this << s << from);
-  callbackData cbd;
+  uint32_t connectionId;
+  if (m_freeSlots.empty ())
+    {
+      connectionId = m_callbackData.size ();
+      m_callbackData.push_back (callbackData ());
+    }
+  else
+    {
+      connectionId = m_freeSlots.back ();
+      m_freeSlots.pop_back ();
+    }
+  callbackData &cbd = m_callbackData [connectionId];
   cbd.currentTxBytes = 0;
   cbd.packetSizeToReturn = 0;
   cbd.send = false;
-  m_callbackData [from] = cbd;
-  m_connectedClients.push_back (from);
-  s->SetRecvCallback (MakeCallback (&TcpStreamServer::HandleRead, this));
-  s->SetSendCallback ( MakeCallback (&TcpStreamServer::HandleSend, this));
+  cbd.connected = true;
+  cbd.requestBytes = 0;
+  m_connectedClients++;
+  s->SetRecvCallback (MakeBoundCallback (&TcpStreamServer::DoHandleRead, this, connectionId));
+  s->SetSendCallback (MakeBoundCallback (&TcpStreamServer::DoHandleSend, this, connectionId));
+  s->SetCloseCallbacks (
+    MakeBoundCallback (&TcpStreamServer::DoHandlePeerClose, this, connectionId),
+    MakeBoundCallback (&TcpStreamServer::DoHandlePeerError, this, connectionId));
 }
 
 void
-TcpStreamServer::HandlePeerClose (Ptr<Socket> socket)
+TcpStreamServer::HandlePeerClose (uint32_t connectionId, Ptr<Socket> socket)
 {
-  NS_LOG_FUNCTION (this << socket);
-  Address from;
-  socket->GetPeerName (from);
-  for (std::vector<Address>::iterator it = m_connectedClients.begin (); it != m_connectedClients.end (); ++it)
-    {
-      if (*it == from)
-        {
-          m_connectedClients.erase (it);
-          // No more clients left in m_connectedClients, simulation is done.
-          if (m_connectedClients.size () == 0)
-            {
-              Simulator::Stop ();
-            }
-          return;
-        }
-    }
+  NS_LOG_FUNCTION (this << connectionId << socket);
+  ReleaseConnection (connectionId, socket);
+}
+
+void
+TcpStreamServer::HandlePeerError (uint32_t connectionId, Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << connectionId << socket);
+  ReleaseConnection (connectionId, socket);
 }
 
 void
-TcpStreamServer::HandlePeerError (Ptr<Socket> socket)
+TcpStreamServer::ReleaseConnection (uint32_t connectionId, Ptr<Socket> socket)
 {
-  NS_LOG_FUNCTION (this << socket);
+  NS_LOG_FUNCTION (this << connectionId << socket);
+  callbackData &cbd = m_callbackData [connectionId];
+  if (!cbd.connected)
+    {
+      return;
+    }
+  // the slot may be handed to the next client, so the socket must not call back with this id anymore
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t > ());
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+  socket->Close ();
+  cbd.connected = false;
+  cbd.send = false;
+  m_freeSlots.push_back (connectionId);
+  m_connectedClients--;
+  // No more clients left, simulation is done.
+  if (m_connectedClients == 0)
+    {
+      Simulator::Stop ();
+    }
 }
 
-int64_t
-TcpStreamServer::GetCommand (Ptr<Packet> packet)
+bool
+TcpStreamServer::GetCommand (callbackData &cbd, Ptr<Packet> packet, TcpStreamRequestHeader &request)
 {
-  int64_t packetSizeToReturn;
-  uint8_t *buffer = new uint8_t [packet->GetSize ()];
-  packet->CopyData (buffer, packet->GetSize ());
-  std::stringstream ss;
-  ss << buffer;
-  std::string str;
-  ss >> str;
-  std::stringstream convert (str);
-  convert >> packetSizeToReturn;
-  return packetSizeToReturn;
+  uint32_t requestSize = request.GetSerializedSize ();
+  NS_ASSERT (requestSize == sizeof (cbd.requestBuffer));
+  if (cbd.requestBytes == 0 && packet->GetSize () >= requestSize)
+    {
+      packet->RemoveHeader (request);
+    }
+  else
+    {
+      uint32_t toCopy = std::min (packet->GetSize (), requestSize - cbd.requestBytes);
+      packet->CopyData (cbd.requestBuffer + cbd.requestBytes, toCopy);
+      packet->RemoveAtStart (toCopy);
+      cbd.requestBytes += toCopy;
+      if (cbd.requestBytes < requestSize)
+        {
+          return false;
+        }
+      cbd.requestBytes = 0;
+      Create<Packet> (cbd.requestBuffer, requestSize)->RemoveHeader (request);
+    }
+  if (packet->GetSize () > 0)
+    {
+      // the client sends its next request only after the segment has been received
+      NS_LOG_WARN ("Ignoring " << packet->GetSize () << " bytes following the request");
+    }
+  return true;
 }
 } // Namespace ns3
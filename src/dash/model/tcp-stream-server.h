@@ -24,7 +24,7 @@
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/traced-callback.h"
-#include <map>
+#include <vector>
 #include "ns3/random-variable-stream.h"
 
 namespace ns3 {
@@ -33,6 +33,7 @@ namespace ns3 {
 
 class Socket;
 class Packet;
+class TcpStreamRequestHeader;
 class PropagationDelayModel;
 
 /**
@@ -49,6 +50,9 @@ struct callbackData
   uint32_t currentTxBytes;//!< already sent bytes for this particular segment, set to 0 if sent bytes == packetSizeToReturn, so transmission for this segment is over
   uint32_t packetSizeToReturn;//!< total amount of bytes that have to be returned to the client
   bool send;//!< true as long as there are still bytes left to be sent for the current segment
+  bool connected;//!< true while this slot is in use by a connected client
+  uint8_t requestBuffer [12];//!< bytes of a segment request that arrived split across reads, a serialized TcpStreamRequestHeader has 12 bytes
+  uint32_t requestBytes;//!< number of bytes in requestBuffer
 };
 
 /**
@@ -68,6 +72,11 @@ public:
   TcpStreamServer ();
   virtual ~TcpStreamServer ();
 
+  /**
+   * \return the number of receive and send callbacks the server has handled so far, for benchmarking purposes
+   */
+  uint64_t GetHandledEvents (void) const;
+
 protected:
   virtual void DoDispose (void);
 
@@ -76,59 +85,88 @@ private:
   virtual void StopApplication (void);
 
   /**
-   * \brief Handle a packet reception, and set SendCallback to HandlSend.
+   * \brief Handle a packet reception on the connection with id connectionId.
    *
    * This function is called by lower layers. The received packet's content
-   * gets deserialized by GetCommand (Ptr<Packet> packet). If the packets content
-   * contains a string composed of an int with
-   * value n, then n bytes will be sent back to the sender.
+   * gets deserialized by GetCommand (). If the packet contains a TcpStreamRequestHeader
+   * requesting a segment of n bytes, then n bytes will be sent back to the sender.
    *
+   * \param connectionId the index of the connection's slot in m_callbackData
    * \param socket the socket the packet was received to.
    */
-  void HandleRead (Ptr<Socket> socket);
+  void HandleRead (uint32_t connectionId, Ptr<Socket> socket);
 
   /**
    * \brief send packetSizeToReturn bytes to the client connected to socket.
    *
-   * This function is called once by HandleRead (Ptr<Socket> socket) after a send of n (i.e.
+   * This function is called once by HandleRead () after a send of n (i.e.
    * a segment of n) bytes was requested by the client. If n > socket->GetTxAvailable (),
    * (this is the current space available in the buffer in bytes), then socket->GetTxAvailable () bytes
    * are written into the buffer. This function will get called again through the SendCallback when
    * space in the buffer has freed up.
    * The amount of sent bytes for this particular segment and for the client connected with
-   * this socket is stored in m_callbackData [from].currentTxBytes, so the server can access the already sent bytes
-   * through the value of from, which is provided by socket, because there is a socket instance for every connected client.
-   * m_callbackData [from].send indicates for the client with address from that the server has not yet sent
-   * m_callbackData [from].packetSizeToReturn bytes. When the number of bytes should be sent is
-   * reached, m_callbackData [from].send will be set to false and the server stops sending
+   * this socket is stored in m_callbackData [connectionId].currentTxBytes. Every accepted socket has its
+   * own slot in m_callbackData, whose index is bound to the socket's callbacks, so no lookup is needed.
+   * m_callbackData [connectionId].send indicates that the server has not yet sent
+   * m_callbackData [connectionId].packetSizeToReturn bytes. When the number of bytes should be sent is
+   * reached, m_callbackData [connectionId].send will be set to false and the server stops sending
    * bytes to the client until he requests another segment.
    *
+   * \param connectionId the index of the connection's slot in m_callbackData
    * \param socket the socket the request for a segment was received to and where the server will send packetSizeToReturn bytes to.
-   * \param packetSizeToReturn the full segment size in bytes that has to be returned to the client
+   * \param txSpace the space available in the socket's send buffer
    */
-  void HandleSend (Ptr<Socket> socket, uint32_t packetSizeToReturn);
+  void HandleSend (uint32_t connectionId, Ptr<Socket> socket, uint32_t txSpace);
 
   /**
-   * \brief Set callback functions for receive and send.
-   * Add the newly connected client to m_connectedClients and allocate callbackData structure for this client.
+   * \brief Allocate a callbackData slot for the newly connected client and set callback functions for receive, send and close.
    */
   void HandleAccept (Ptr<Socket> s, const Address& from);
 
-  void HandlePeerClose (Ptr<Socket> socket);
-  void HandlePeerError (Ptr<Socket> socket);
+  /**
+   * \brief Release the slot of a connection closed by the client, see ReleaseConnection ().
+   */
+  void HandlePeerClose (uint32_t connectionId, Ptr<Socket> socket);
+  /**
+   * \brief Release the slot of a connection closed by an error, see ReleaseConnection ().
+   */
+  void HandlePeerError (uint32_t connectionId, Ptr<Socket> socket);
+  /**
+   * \brief Detach the callbacks from the socket, close it and release its slot. When no clients are left, the simulation is stopped.
+   */
+  void ReleaseConnection (uint32_t connectionId, Ptr<Socket> socket);
+
+  /**
+   * \name Trampolines
+   * Socket callbacks are bound to these functions together with the server and the connection id.
+   */
+  //\{
+  static void DoHandleRead (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket);
+  static void DoHandleSend (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket, uint32_t txSpace);
+  static void DoHandlePeerClose (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket);
+  static void DoHandlePeerError (TcpStreamServer *server, uint32_t connectionId, Ptr<Socket> socket);
+  //\}
 
   /**
    * \brief Deserialize what the client has sent us.
+   *
+   * A complete request is parsed in place from the packet, without copying its content. When a request
+   * arrives split across reads, its bytes are collected in the connection's requestBuffer until it is complete.
+   *
+   * \param cbd the slot of the connection the packet was received on
    * \param packet the data the client has sent us
-   * \return the deserialized packet content as a string
+   * \param request the deserialized segment request
+   * \return false if no complete request has been received yet
    */
-  int64_t GetCommand (Ptr<Packet> packet);
+  bool GetCommand (callbackData &cbd, Ptr<Packet> packet, TcpStreamRequestHeader &request);
 
   uint16_t m_port; //!< Port on which we listen for incoming packets.
   Ptr<Socket> m_socket; //!< IPv4 Socket
   Ptr<Socket> m_socket6; //!< IPv6 Socket
-  std::map <Address, callbackData> m_callbackData; //!< With this it is possible to access the currentTxBytes, the packetSizeToReturn and the send boolean through the from value of the client.
-  std::vector<Address> m_connectedClients; //!< Vector which holds the list of currently connected clients.
+  std::vector<callbackData> m_callbackData; //!< One slot per connection, indexed by the connection id bound to the connection's socket callbacks.
+  std::vector<uint32_t> m_freeSlots; //!< Ids of slots in m_callbackData whose connection has been closed, reused for new connections.
+  uint32_t m_connectedClients; //!< Number of currently connected clients.
+  uint64_t m_handledEvents; //!< Number of receive and send callbacks handled, for benchmarking purposes.
 
 
 };
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "throughput-estimator.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+ThroughputEstimator::ThroughputEstimator (int64_t windowDuration, uint32_t windowSamples)
+  : m_windowDuration (windowDuration),
+    m_windowSamples (windowSamples),
+    m_timeWindowBits (0.0),
+    m_timeWindowTime (0.0),
+    m_lastWindowStart (0),
+    m_inverseSum (0.0),
+    m_empty (true)
+{
+  NS_ASSERT_MSG (m_windowSamples > 0, "The sample window must contain at least one segment");
+}
+
+void
+ThroughputEstimator::AddSegment (int64_t transmissionRequested, int64_t transmissionEnd, double bits)
+{
+  NS_ASSERT_MSG (m_empty || transmissionEnd >= m_last.transmissionEnd, "Segments must be added in the order of their transmission end");
+  Download download;
+  download.transmissionRequested = transmissionRequested;
+  download.transmissionEnd = transmissionEnd;
+  download.bits = bits;
+  m_last = download;
+  m_empty = false;
+
+  if (transmissionEnd >= m_lastWindowStart)
+    {
+      m_timeWindow.push_back (download);
+      m_timeWindowBits += bits;
+      m_timeWindowTime += transmissionEnd - transmissionRequested;
+    }
+
+  // segments without payload or without download time can't be turned into a throughput sample
+  if (bits > 0 && transmissionEnd > transmissionRequested)
+    {
+      double throughput = bits / ((transmissionEnd - transmissionRequested) / 1000000.0);
+      m_sampleWindow.push_back (throughput);
+      m_inverseSum += 1.0 / throughput;
+      if (m_sampleWindow.size () > m_windowSamples)
+        {
+          m_inverseSum -= 1.0 / m_sampleWindow.front ();
+          m_sampleWindow.pop_front ();
+        }
+    }
+}
+
+double
+ThroughputEstimator::GetWindowedThroughput (int64_t timeNow)
+{
+  if (m_empty)
+    {
+      return 0;
+    }
+  int64_t windowStart = timeNow - m_windowDuration;
+  if (windowStart < 0)
+    {
+      windowStart = 0;
+    }
+  NS_ASSERT_MSG (windowStart >= m_lastWindowStart, "The time window can only move forward");
+  m_lastWindowStart = windowStart;
+
+  while (!m_timeWindow.empty () && m_timeWindow.front ().transmissionEnd < windowStart)
+    {
+      const Download &oldest = m_timeWindow.front ();
+      m_timeWindowBits -= oldest.bits;
+      m_timeWindowTime -= oldest.transmissionEnd - oldest.transmissionRequested;
+      m_timeWindow.pop_front ();
+    }
+  if (m_timeWindow.empty ())
+    {
+      m_timeWindowBits = 0.0;
+      m_timeWindowTime = 0.0;
+      // as for the samples, a download without download time yields no throughput
+      if (m_last.transmissionEnd <= m_last.transmissionRequested)
+        {
+          return 0;
+        }
+      return m_last.bits / ((m_last.transmissionEnd - m_last.transmissionRequested) / 1000000.0);
+    }
+
+  double bits = m_timeWindowBits;
+  double time = m_timeWindowTime;
+  const Download &oldest = m_timeWindow.front ();
+  if (oldest.transmissionRequested < windowStart)
+    {
+      // only the part of the download time inside the window counts
+      bits -= oldest.bits;
+      time -= (oldest.transmissionEnd - oldest.transmissionRequested) - (oldest.transmissionEnd - windowStart);
+    }
+  if (time <= 0)
+    {
+      return 0;
+    }
+  return bits / (time / 1000000.0);
+}
+
+double
+ThroughputEstimator::GetHarmonicMeanThroughput (void) const
+{
+  if (m_sampleWindow.empty ())
+    {
+      return 0;
+    }
+  return m_sampleWindow.size () / m_inverseSum;
+}
+
+double
+ThroughputEstimator::GetLastThroughput (void) const
+{
+  if (m_sampleWindow.empty ())
+    {
+      return 0;
+    }
+  return m_sampleWindow.back ();
+}
+
+uint32_t
+ThroughputEstimator::GetNumberOfSamples (void) const
+{
+  return m_sampleWindow.size ();
+}
+
+} // namespace ns3
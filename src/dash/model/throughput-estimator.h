@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright 2016 Technische Universitaet Berlin
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef THROUGHPUT_ESTIMATOR_H
+#define THROUGHPUT_ESTIMATOR_H
+
+#include <stdint.h>
+#include <deque>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Incremental throughput estimator for adaptation algorithms.
+ *
+ * The estimator is fed with every completed segment download through AddSegment () and keeps
+ * running sums over a sliding time window and over a sliding window of the most recent segments,
+ * so every estimate is computed in amortized O(1), independent of the length of the session.
+ * All points in time are given in microseconds, throughputs in bits per second.
+ */
+class ThroughputEstimator
+{
+public:
+  /**
+   * \param windowDuration duration of the sliding time window in microseconds
+   * \param windowSamples number of segments in the sliding sample window
+   */
+  ThroughputEstimator (int64_t windowDuration, uint32_t windowSamples);
+
+  /**
+   * \brief Add a completed segment download.
+   *
+   * Segments must be added in the order of their transmission end.
+   *
+   * \param transmissionRequested point in time when the segment was requested
+   * \param transmissionEnd point in time when the last packet of the segment was received
+   * \param bits the number of bits credited to this download
+   */
+  void AddSegment (int64_t transmissionRequested, int64_t transmissionEnd, double bits);
+
+  /**
+   * \brief Average throughput, weighted with download time, over the downloads ended in the time window.
+   *
+   * The time window is [timeNow - windowDuration, timeNow]. A download ended inside the window, but requested
+   * before its start, only contributes its download time inside the window, not its bits, as in the TOBASCO
+   * algorithm. If no download ended inside the window, the last download is used. Successive calls must pass
+   * non-decreasing values of timeNow.
+   *
+   * \param timeNow the end of the time window
+   * \return the average throughput, or 0 if no segment has been added yet or the downloads took no time
+   */
+  double GetWindowedThroughput (int64_t timeNow);
+
+  /**
+   * \return the harmonic mean of the throughputs of the segments in the sample window, or 0 if no segment has been added yet
+   */
+  double GetHarmonicMeanThroughput (void) const;
+
+  /**
+   * \return the throughput of the last added segment, or 0 if no segment has been added yet
+   */
+  double GetLastThroughput (void) const;
+
+  /**
+   * \return the number of segments currently in the sample window
+   */
+  uint32_t GetNumberOfSamples (void) const;
+
+private:
+  /**
+   * \brief A completed segment download
+   */
+  struct Download
+  {
+    int64_t transmissionRequested; //!< point in time when the segment was requested
+    int64_t transmissionEnd; //!< point in time when the last packet of the segment was received
+    double bits; //!< number of bits credited to this download
+  };
+
+  const int64_t m_windowDuration; //!< duration of the sliding time window
+  const uint32_t m_windowSamples; //!< number of segments in the sliding sample window
+
+  std::deque<Download> m_timeWindow; //!< downloads ended inside the time window, oldest first
+  double m_timeWindowBits; //!< sum of the bits of the downloads in m_timeWindow
+  double m_timeWindowTime; //!< sum of the download times of the downloads in m_timeWindow
+  int64_t m_lastWindowStart; //!< start of the time window of the last call to GetWindowedThroughput ()
+
+  std::deque<double> m_sampleWindow; //!< throughputs of the most recent segments, oldest first
+  double m_inverseSum; //!< sum of the inverse throughputs in m_sampleWindow
+
+  Download m_last; //!< the last added download
+  bool m_empty; //!< true as long as no segment has been added
+};
+
+} // namespace ns3
+
+#endif /* THROUGHPUT_ESTIMATOR_H */
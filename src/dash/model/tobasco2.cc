@@ -40,13 +40,21 @@ TobascoAlgorithm::TobascoAlgorithm (  const videoData &videoData,
   m_bOpt ((int64_t)(0.5 * (m_bLow + m_bHigh))),
   m_deltaBeta (1000000),
   m_deltaTime (10000000),
-  m_highestRepIndex (videoData.averageBitrate.size () - 1)
+  m_highestRepIndex (videoData.averageBitrate.size () - 1),
+  m_estimator (m_deltaTime, 1)
 {
   NS_LOG_INFO (this);
   m_runningFastStart = true;
   NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be >= 0");
 }
 
+size_t
+TobascoAlgorithm::GetHistoryDepth (void) const
+{
+  // the last two downloads, see MinimumBufferLevelObserved ()
+  return 2;
+}
+
 algorithmReply
 TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
 {
@@ -64,7 +72,7 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
     {
       nextRepIndex = m_lastRepIndex;
       bufferNow = m_bufferData.bufferLevelNew.back () - (timeNow - m_throughput.transmissionEnd.back ());
-      double averageSegmentThroughput = AverageSegmentThroughput (timeNow - m_deltaTime, timeNow);
+      double averageSegmentThroughput = m_estimator.GetWindowedThroughput (timeNow);
       double nextHighestRepBitrate;
       if (m_lastRepIndex < m_highestRepIndex)
         {
@@ -122,16 +130,16 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
             }
           else if (bufferNow < m_bLow)
             {
-              double lastSegmentThroughput = (8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (segmentCounter - 1))
+              double lastSegmentThroughput = (8.0 * m_videoData.GetSegmentSize (m_lastRepIndex, segmentCounter - 1))
                 / ((double)(m_throughput.transmissionEnd.at (segmentCounter - 1) - m_throughput.transmissionStart.at (segmentCounter - 1)) / 1000000.0);
 
               if ((m_lastRepIndex != 0)
-                  && ((8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (segmentCounter - 1)) / timeFactor >= lastSegmentThroughput))
+                  && ((8.0 * m_videoData.GetSegmentSize (m_lastRepIndex, segmentCounter - 1)) / timeFactor >= lastSegmentThroughput))
                 {
                   decisionCase = 5;
                   for (int i = m_highestRepIndex; i >= 0; i--)
                     {
-                      if ((8.0 * m_videoData.segmentSize.at (i).at (segmentCounter - 1)) / timeFactor >= lastSegmentThroughput)
+                      if ((8.0 * m_videoData.GetSegmentSize (i, segmentCounter - 1)) / timeFactor >= lastSegmentThroughput)
                         {
                           continue;
                         }
@@ -201,8 +209,8 @@ TobascoAlgorithm::MinimumBufferLevelObserved ()
     {
       return true;
     }
-  int64_t lastPackage = m_throughput.transmissionEnd.end ()[-1];
-  int64_t secondToLastPackage = m_throughput.transmissionEnd.end ()[-2];
+  int64_t lastPackage = m_throughput.transmissionEnd.at (m_throughput.transmissionEnd.size () - 1);
+  int64_t secondToLastPackage = m_throughput.transmissionEnd.at (m_throughput.transmissionEnd.size () - 2);
 
   if (m_deltaBeta < m_videoData.segmentDuration)
     {
@@ -228,65 +236,12 @@ TobascoAlgorithm::MinimumBufferLevelObserved ()
     }
 }
 
-double
-TobascoAlgorithm::AverageSegmentThroughput (int64_t t_1, int64_t t_2)
+void
+TobascoAlgorithm::SegmentReceived (const int64_t segmentCounter)
 {
-  if (t_1 < 0)
-    {
-      t_1 = 0;
-    }
-  if (m_throughput.transmissionEnd.size () < 1)
-    {
-      return 0;
-    }
-
-
-  // First, we have to find the index of the start of the download of the first downloaded segment in
-  // the interval [t_1, t_2]
-  uint index = 0;
-  for (uint i = 0; i <= m_throughput.transmissionEnd.size () - 1; i++)
-    {
-      if (m_throughput.transmissionEnd.at (i) < t_1)
-        {
-          continue;
-        }
-      else
-        {
-          index = i;
-          break;
-        }
-    }
-
-  double lengthOfInterval;
-  double sumThroughput = 0.0;
-  double transmissionTime = 0.0;
-  if (m_throughput.transmissionRequested.at (index) < t_1)
-    {
-      lengthOfInterval = m_throughput.transmissionEnd.at (index) - t_1;
-      sumThroughput += (m_videoData.averageBitrate.at (m_playbackData.playbackIndex.at (index)) * ((m_throughput.transmissionEnd.at (index) - t_1)
-                                                                                                   / (m_throughput.transmissionEnd.at (index) - m_throughput.transmissionRequested.at (index)))) * lengthOfInterval;
-      transmissionTime += lengthOfInterval;
-      index++;
-      if (index >= m_throughput.transmissionEnd.size ())
-        {
-          return (sumThroughput / (double)transmissionTime);
-        }
-    }
-  // Compute the average download-time of all the fully completed segment downloads during [t_1, t_2].
-  while (m_throughput.transmissionEnd.at (index) <= t_2)
-    {
-      lengthOfInterval = m_throughput.transmissionEnd.at (index) - m_throughput.transmissionRequested.at (index);
-      sumThroughput += ((m_videoData.averageBitrate.at (m_playbackData.playbackIndex.at (index)) * m_videoData.segmentDuration)
-                        / lengthOfInterval)  * lengthOfInterval;
-      transmissionTime += lengthOfInterval;
-      index++;
-      if (index > m_throughput.transmissionEnd.size () - 1)
-        {
-          break;
-        }
-    }
-  return (sumThroughput / (double)transmissionTime);
-
+  // every segment is credited with the average bitrate of its representation level
+  m_estimator.AddSegment (m_throughput.transmissionRequested.back (), m_throughput.transmissionEnd.back (),
+                          m_videoData.averageBitrate.at (m_playbackData.playbackIndex.at (segmentCounter))
+                          * (m_videoData.segmentDuration / 1000000.0));
 }
 } // namespace ns3
-
@@ -20,6 +20,7 @@
 #define TOBASCO_ALGORITHM_H
 
 #include "tcp-stream-adaptation-algorithm.h"
+#include "throughput-estimator.h"
 
 namespace ns3 {
 
@@ -35,14 +36,13 @@ public:
                       const bufferData & bufferData,
                       const throughputData & throughput);
 
+  size_t GetHistoryDepth (void) const;
+
   algorithmReply GetNextRep ( const int64_t segmentCounter, int64_t clientId);
 
-private:
-  /**
-   * \brief Average segment throughput during the time interval [t1, t2]
-   */
-  double AverageSegmentThroughput (int64_t t1, int64_t t2);
+  void SegmentReceived (const int64_t segmentCounter);
 
+private:
 
   /**
    * Was the minimum buffer level observed during a time interval with duration delta_beta
@@ -67,6 +67,7 @@ private:
   const int64_t m_highestRepIndex;
   int64_t m_lastRepIndex;
   bool m_runningFastStart;
+  ThroughputEstimator m_estimator; //!< average segment throughput during the last m_deltaTime microseconds
 };
 } // namespace ns3
 #endif /* TOBASCO_ALGORITHM_H */
\ No newline at end of file